@@ -0,0 +1,271 @@
+#include "alloccounter.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<std::size_t> g_allocations{0};
+static std::atomic<std::size_t> g_bytes{0};
+static std::atomic<std::size_t> g_live{0};
+static std::atomic<std::size_t> g_peak{0};
+
+static inline void count(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+std::size_t AllocCounter::allocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t AllocCounter::allocatedBytes() {
+    return g_bytes.load(std::memory_order_relaxed);
+}
+
+std::size_t AllocCounter::liveBytes() {
+    return g_live.load(std::memory_order_relaxed);
+}
+
+std::size_t AllocCounter::peakBytes() {
+    return g_peak.load(std::memory_order_relaxed);
+}
+
+void AllocCounter::resetPeak() {
+    g_peak.store(g_live.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+bool AllocCounter::tracksLiveBytes() {
+    return true;
+}
+
+static inline void acquire(void* ptr) {
+    if (!ptr)
+        return;
+    std::size_t size = malloc_usable_size(ptr);
+    std::size_t live =
+        g_live.fetch_add(size, std::memory_order_relaxed) + size;
+    std::size_t peak = g_peak.load(std::memory_order_relaxed);
+    while (live > peak &&
+           !g_peak.compare_exchange_weak(peak, live,
+                                         std::memory_order_relaxed)) {
+    }
+}
+
+static inline void release(void* ptr) {
+    if (ptr)
+        g_live.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+}
+
+// Interpose the C allocator so that Qt's own buffers (QString, QByteArray,
+// QJsonArray, ...) are counted too; operator new ends up here as well.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    count(size);
+    void* ptr = __libc_malloc(size);
+    acquire(ptr);
+    return ptr;
+}
+
+void* calloc(size_t n, size_t size) {
+    // n * size must not wrap; glibc fails such a request with ENOMEM
+    if (size && n > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    count(n * size);
+    void* ptr = __libc_calloc(n, size);
+    acquire(ptr);
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+    count(size);
+    std::size_t old = ptr ? malloc_usable_size(ptr) : 0;
+    void* result = __libc_realloc(ptr, size);
+    if (result || size == 0) {
+        g_live.fetch_sub(old, std::memory_order_relaxed);
+        acquire(result);
+    }
+    return result;
+}
+
+// Over-aligned operator new and std::pmr resources end up here.
+void* memalign(size_t alignment, size_t size) {
+    count(size);
+    void* ptr = __libc_memalign(alignment, size);
+    acquire(ptr);
+    return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    // a power of two multiple of sizeof(void*); *ptr is left alone on error
+    if (alignment == 0 || alignment % sizeof(void*) != 0 ||
+        (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void* result = memalign(alignment, size);
+    if (!result)
+        return ENOMEM;
+    *ptr = result;
+    return 0;
+}
+
+void free(void* ptr) {
+    release(ptr);
+    __libc_free(ptr);
+}
+}
+#else
+bool AllocCounter::tracksLiveBytes() {
+    return false;
+}
+
+// Elsewhere only C++ allocations can be observed portably, so every
+// replaceable operator new and delete is replaced; C allocations go
+// uncounted.
+static void* allocate(std::size_t size) {
+    count(size);
+    for (;;) {
+        if (void* ptr = std::malloc(size ? size : 1))
+            return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+// Over-allocates and keeps the pointer malloc returned just below the
+// aligned block, where alignedFree() finds it.
+static void* allocateAligned(std::size_t size, std::align_val_t align) {
+    const std::size_t alignment = static_cast<std::size_t>(align);
+    if (size > SIZE_MAX - alignment - sizeof(void*))
+        throw std::bad_alloc();
+    void* raw = allocate(size + alignment + sizeof(void*));
+    std::uintptr_t start =
+        reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+    void* ptr = reinterpret_cast<void*>((start + alignment - 1) &
+                                        ~std::uintptr_t(alignment - 1));
+    static_cast<void**>(ptr)[-1] = raw;
+    return ptr;
+}
+
+static void alignedFree(void* ptr) {
+    if (ptr)
+        std::free(static_cast<void**>(ptr)[-1]);
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return allocateAligned(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return allocateAligned(size, align);
+}
+
+void* operator new(std::size_t size, std::align_val_t align,
+                   const std::nothrow_t&) noexcept {
+    try {
+        return allocateAligned(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t align,
+                     const std::nothrow_t&) noexcept {
+    try {
+        return allocateAligned(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+    alignedFree(ptr);
+}
+#endif
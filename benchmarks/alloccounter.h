@@ -0,0 +1,23 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+#include <cstddef>
+
+/* With glibc the C allocator is interposed, so every heap allocation is
+   counted, Qt's own buffers included. Elsewhere only the replaceable
+   operator new and delete are replaced: C++ allocations are counted, while
+   malloc() calls, such as Qt's QString and QByteArray buffers, are not. */
+namespace AllocCounter {
+/* Number of heap allocations performed by the process so far */
+std::size_t allocations();
+/* Bytes requested by those allocations */
+std::size_t allocatedBytes();
+
+/* Heap bytes currently in use and the most in use since resetPeak(); only
+   tracked when tracksLiveBytes() (glibc) */
+bool tracksLiveBytes();
+std::size_t liveBytes();
+std::size_t peakBytes();
+void resetPeak();
+}  // namespace AllocCounter
+
+#endif // ALLOCCOUNTER_H
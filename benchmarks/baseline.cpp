@@ -0,0 +1,191 @@
+#include "baseline.h"
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <cmath>
+
+static double median(QVector<double> values) {
+    if (values.isEmpty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    int mid = values.size() / 2;
+    if (values.size() % 2)
+        return values[mid];
+    return (values[mid - 1] + values[mid]) / 2;
+}
+
+/* Median absolute deviation scaled to estimate the standard deviation of
+   normally distributed samples */
+static double mad(const QVector<double>& values, double center) {
+    QVector<double> deviations;
+    deviations.reserve(values.size());
+    for (double v : values)
+        deviations.append(std::fabs(v - center));
+    return 1.4826 * median(deviations);
+}
+
+/* Standard error of a median of n samples with spread sigma */
+static double medianError(double sigma, int n) {
+    return n > 0 ? 1.2533 * sigma / std::sqrt(double(n)) : 0;
+}
+
+QString BenchSummary::key() const {
+    return QString("%1/%2/%3").arg(op, name).arg(size);
+}
+
+QJsonObject BenchSummary::toJson() const {
+    const BenchResult& r = median;
+    QJsonObject item;
+    item["name"] = name;
+    item["op"] = op;
+    item["size"] = size;
+    item["iterations"] = r.iterations;
+    item["bytes"] = r.bytes;
+    item["objects"] = r.objects;
+    item["ns_per_op"] = nsPerOp;
+    item["ns_per_op_mad"] = nsMad;
+    QJsonArray samples;
+    for (double ns : nsSamples)
+        samples.append(ns);
+    item["ns_per_op_samples"] = samples;
+    item["mb_per_s"] = r.mbPerSec();
+    item["objects_per_s"] = r.objectsPerSec();
+    item["allocations"] = allocations;
+    item["allocated_bytes"] = allocatedBytes;
+    if (r.hasCounters) {
+        item["cycles"] = r.cycles;
+        item["instructions"] = r.instructions;
+        item["ipc"] = r.ipc();
+        item["cache_misses"] = r.cacheMisses;
+        item["branch_misses"] = r.branchMisses;
+    }
+    if (r.peakRss >= 0)
+        item["peak_rss"] = r.peakRss;
+    if (r.peakHeap >= 0)
+        item["peak_heap"] = r.peakHeap;
+    return item;
+}
+
+BenchSummary BenchSummary::fromJson(const QJsonObject& json) {
+    BenchSummary s;
+    s.name = json["name"].toString();
+    s.op = json["op"].toString();
+    s.size = json["size"].toInt();
+    s.nsPerOp = json["ns_per_op"].toDouble();
+    s.nsMad = json["ns_per_op_mad"].toDouble();
+    const QJsonArray samples = json["ns_per_op_samples"].toArray();
+    for (const QJsonValue v : samples)
+        s.nsSamples.append(v.toDouble());
+    if (s.nsSamples.isEmpty())
+        s.nsSamples.append(s.nsPerOp);
+    s.allocations = qint64(json["allocations"].toDouble());
+    s.allocatedBytes = qint64(json["allocated_bytes"].toDouble());
+    return s;
+}
+
+QVector<BenchSummary> summarize(const QVector<BenchResult>& results) {
+    QVector<BenchSummary> summaries;
+    QHash<QString, int> index;
+    QVector<QVector<BenchResult>> groups;
+    for (const BenchResult& r : results) {
+        QString key = QString("%1/%2/%3").arg(r.op, r.name).arg(r.size);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            it = index.insert(key, groups.size());
+            groups.append(QVector<BenchResult>());
+        }
+        groups[*it].append(r);
+    }
+
+    for (QVector<BenchResult>& group : groups) {
+        std::sort(group.begin(), group.end(),
+                  [](const BenchResult& a, const BenchResult& b) {
+                      return a.nsPerOp() < b.nsPerOp();
+                  });
+        BenchSummary s;
+        s.name = group.first().name;
+        s.op = group.first().op;
+        s.size = group.first().size;
+        s.median = group[group.size() / 2];
+        s.allocations = group.first().allocations;
+        s.allocatedBytes = group.first().allocatedBytes;
+        for (const BenchResult& r : group) {
+            s.nsSamples.append(r.nsPerOp());
+            s.allocations = qMin(s.allocations, r.allocations);
+            s.allocatedBytes = qMin(s.allocatedBytes, r.allocatedBytes);
+        }
+        s.nsPerOp = median(s.nsSamples);
+        s.nsMad = mad(s.nsSamples, s.nsPerOp);
+        summaries.append(s);
+    }
+    return summaries;
+}
+
+bool loadBaseline(const QString& path, QVector<BenchSummary>& baseline) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "cannot read benchmark baseline" << path;
+        return false;
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) {
+        qWarning() << "benchmark baseline is not a report" << path;
+        return false;
+    }
+    const QJsonArray results = doc.object()["results"].toArray();
+    for (const QJsonValue v : results)
+        baseline.append(BenchSummary::fromJson(v.toObject()));
+    return true;
+}
+
+int compareWithBaseline(const QVector<BenchSummary>& current,
+                        const QVector<BenchSummary>& baseline,
+                        double threshold) {
+    QHash<QString, const BenchSummary*> base;
+    for (const BenchSummary& s : baseline)
+        base.insert(s.key(), &s);
+
+    int regressions = 0;
+    int improvements = 0;
+    int missing = 0;
+    for (const BenchSummary& cur : current) {
+        const BenchSummary* old = base.value(cur.key());
+        if (!old) {
+            ++missing;
+            continue;
+        }
+
+        double delta = cur.nsPerOp - old->nsPerOp;
+        double ratio = old->nsPerOp > 0 ? cur.nsPerOp / old->nsPerOp : 1;
+        double noise = 1.96 * std::hypot(
+            medianError(cur.nsMad, cur.nsSamples.size()),
+            medianError(old->nsMad, old->nsSamples.size()));
+        bool slower = ratio > 1 + threshold && delta > noise;
+        bool faster = ratio < 1 - threshold && -delta > noise;
+        bool moreAllocations =
+            cur.allocations > old->allocations * (1 + threshold) ||
+            cur.allocatedBytes > old->allocatedBytes * (1 + threshold);
+
+        const char* verdict = "ok";
+        if (slower || moreAllocations) {
+            verdict = "REGRESSED";
+            ++regressions;
+        } else if (faster) {
+            verdict = "improved";
+            ++improvements;
+        }
+        qInfo().noquote() << QString::asprintf(
+            "%-10s %-40s %12.1f -> %12.1f ns/op (%+6.1f%%, noise %.1f) "
+            "%8lld -> %8lld allocs/op",
+            verdict, qPrintable(cur.key()), old->nsPerOp, cur.nsPerOp,
+            (ratio - 1) * 100, noise, old->allocations, cur.allocations);
+    }
+
+    qInfo().noquote() << QString::asprintf(
+        "%d regressed, %d improved, %d without baseline (threshold %.1f%%)",
+        regressions, improvements, missing, threshold * 100);
+    return regressions;
+}
@@ -0,0 +1,37 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+#include "report.h"
+#include <QJsonObject>
+
+/* All repetitions of one case reduced to robust statistics */
+struct BenchSummary {
+    QString name;
+    QString op;
+    int size = 0;
+    BenchResult median;         // the repetition with the median time
+    QVector<double> nsSamples;  // ns/op of every repetition
+    double nsPerOp = 0;         // median of nsSamples
+    double nsMad = 0;           // median absolute deviation, scaled to sigma
+    qint64 allocations = 0;     // fewest seen over the repetitions
+    qint64 allocatedBytes = 0;
+
+    QString key() const;
+    QJsonObject toJson() const;
+    static BenchSummary fromJson(const QJsonObject& json);
+};
+
+/* Group the results by case and reduce the repetitions */
+QVector<BenchSummary> summarize(const QVector<BenchResult>& results);
+
+bool loadBaseline(const QString& path, QVector<BenchSummary>& baseline);
+
+/* Print every case next to its baseline and return the number of
+   regressions. A case regresses when its median time grows by more than
+   `threshold` (0.05 = 5%) and the growth is also larger than the noise of
+   both runs at ~95% confidence, or when its allocations grow by more than
+   `threshold`. */
+int compareWithBaseline(const QVector<BenchSummary>& current,
+                        const QVector<BenchSummary>& baseline,
+                        double threshold);
+
+#endif // BASELINE_H
@@ -1,303 +1,140 @@
 #include "bench.h"
+#include "alloccounter.h"
+#include "benchcases.h"
+#include "report.h"
 #include <QDebug>
-
-void Bench::bench_field_int_toJson() {
-    TestField_int test;
-    test.field_int = 999;
-    QBENCHMARK{
-        test.toJson();
-    }
-}
-
-void Bench::bench_field_int_toXml() {
-    TestField_int test;
-    test.field_int = 999;
-    QBENCHMARK{
-        test.toXml();
-    }
-}
-
-void Bench::bench_field_int_fromJson() {
-    TestField_int test;
-    test.field_int = 999;
-    QJsonObject json = test.toJson();
-    TestField_int dest;
-    QBENCHMARK{
-        dest.fromJson(json);
-    }
-}
-
-void Bench::bench_field_int_fromXml() {
-    TestField_int test;
-    test.field_int = 999;
-    QDomNode xml = test.toXml();
-    TestField_int dest;
-    QBENCHMARK{
-        dest.fromXml(QSerializer::toByteArray(xml));
-    }
-}
-
-void Bench::bench_field_string_toJson() {
-    TestField_string test;
-    test.field_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-    QBENCHMARK{
-        test.toJson();
-    }
-}
-
-void Bench::bench_field_string_toXml() {
-    TestField_string test;
-    test.field_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-    QBENCHMARK{
-        test.toXml();
-    }
-}
-
-void Bench::bench_field_string_fromJson() {
-    TestField_string test;
-    test.field_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-    QJsonObject json = test.toJson();
-    TestField_string dest;
-    QBENCHMARK{
-        dest.fromJson(json);
+#include <functional>
+
+const char* Bench::opName(Op op) {
+    switch (op) {
+    case Bench::ToJson: return "toJson";
+    case Bench::ToRawJson: return "toRawJson";
+    case Bench::FromJson: return "fromJson";
+    case Bench::FromRawJson: return "fromRawJson";
+    case Bench::ToXml: return "toXml";
+    case Bench::ToRawXml: return "toRawXml";
+    case Bench::FromXml: return "fromXml";
+    case Bench::FromRawXml: return "fromRawXml";
+    }
+    return "";
+}
+
+std::function<void()> Bench::operation(Op op, QSerializer& src,
+                                       QSerializer& dest, qint64* payload) {
+    const bool isJson = op <= FromRawJson;
+    const QByteArray raw = isJson ? src.toRawJson() : src.toRawXml();
+    if (payload)
+        *payload = raw.size();
+
+    QSerializer* s = &src;
+    QSerializer* d = &dest;
+    switch (op) {
+    case ToJson: return [s] { s->toJson(); };
+    case ToRawJson: return [s] { s->toRawJson(); };
+    case FromJson: {
+        const QJsonObject json = src.toJson();
+        return [d, json] { d->fromJson(json); };
+    }
+    case FromRawJson: return [d, raw] { d->fromJson(raw); };
+    case ToXml: return [s] { s->toXml(); };
+    case ToRawXml: return [s] { s->toRawXml(); };
+    case FromXml: {
+        const QDomNode xml = src.toXml();
+        return [d, xml] { d->fromXml(xml); };
+    }
+    case FromRawXml: return [d, raw] { d->fromXml(raw); };
+    }
+    return [] {};
+}
+
+void Bench::addRows() {
+    QTest::addColumn<QString>("caseName");
+    QTest::addColumn<int>("size");
+    for (const BenchCase& c : benchCases()) {
+        const QVector<int> sizes = c.sized ? benchSizes() : QVector<int>{1};
+        for (int size : sizes) {
+            QString tag = QString("%1/%2").arg(c.name).arg(size);
+            QTest::newRow(qPrintable(tag)) << c.name << size;
+        }
     }
 }
 
-void Bench::bench_field_string_fromXml() {
-    TestField_string test;
-    test.field_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-    QDomNode xml = test.toXml();
-    TestField_string dest;
-    QBENCHMARK{
-        dest.fromXml(QSerializer::toByteArray(xml));
-    }
-}
+void Bench::run(Op op) {
+    QFETCH(QString, caseName);
+    QFETCH(int, size);
+    const BenchCase* c = findBenchCase(caseName);
+    QVERIFY(c);
 
-void Bench::bench_collection_vector_int_toJson() {
-    TestCollection_vector_int test;
-    for(int i = 0; i < 100; i++)
-        test.vector_int.append(i);
-    QBENCHMARK{
-        test.toJson();
-    }
-}
+    std::unique_ptr<QSerializer> src = c->make(size);
+    std::unique_ptr<QSerializer> dest = c->create();
+    qint64 payload = 0;
+    std::function<void()> call = operation(op, *src, *dest, &payload);
 
-void Bench::bench_collection_vector_int_toXml() {
-    TestCollection_vector_int test;
-    for(int i = 0; i < 100; i++)
-        test.vector_int.append(i);
-    QBENCHMARK{
-        test.toXml();
+    BenchRun run(c->name, opName(op), size, payload, c->objects(size));
+    QBENCHMARK {
+        call();
+        run.tick();
     }
+    run.countAllocations(call);
+    run.finish();
 }
 
-void Bench::bench_collection_vector_int_fromJson() {
-    TestCollection_vector_int test;
-    for(int i = 0; i < 100; i++)
-        test.vector_int.append(i);
-    QJsonObject json = test.toJson();
-    TestCollection_vector_int dest;
-    QBENCHMARK{
-        dest.fromJson(json);
-    }
-}
+void Bench::toJson_data() { addRows(); }
+void Bench::toJson() { run(ToJson); }
 
-void Bench::bench_collection_vector_int_fromXml() {
-    TestCollection_vector_int test;
-    for(int i = 0; i < 100; i++)
-        test.vector_int.append(i);
-    QDomNode xml = test.toXml();
-    TestCollection_vector_int dest;
-    QBENCHMARK{
-        dest.fromXml(QSerializer::toByteArray(xml));
-    }
-}
+void Bench::toRawJson_data() { addRows(); }
+void Bench::toRawJson() { run(ToRawJson); }
 
-void Bench::bench_collection_vector_string_toJson() {
-    TestCollection_vector_string test;
-    for(int i = 0; i < 100; i++)
-        test.vector_string.append(QString::number(i));
-    QBENCHMARK{
-        test.toJson();
-    }
-}
+void Bench::fromJson_data() { addRows(); }
+void Bench::fromJson() { run(FromJson); }
 
-void Bench::bench_collection_vector_string_toXml() {
-    TestCollection_vector_string test;
-    for(int i = 0; i < 100; i++)
-        test.vector_string.append(QString::number(i));
-    QBENCHMARK{
-        test.toXml();
-    }
-}
+void Bench::fromRawJson_data() { addRows(); }
+void Bench::fromRawJson() { run(FromRawJson); }
 
-void Bench::bench_collection_vector_string_fromJson() {
-    TestCollection_vector_string test;
-    for(int i = 0; i < 100; i++)
-        test.vector_string.append(QString::number(i));
-    QJsonObject json = test.toJson();
-    TestCollection_vector_string dest;
-    QBENCHMARK{
-        dest.fromJson(json);
-    }
-}
+void Bench::toXml_data() { addRows(); }
+void Bench::toXml() { run(ToXml); }
 
-void Bench::bench_collection_vector_string_fromXml() {
-    TestCollection_vector_string test;
-    for(int i = 0; i < 100; i++)
-        test.vector_string.append(QString::number(i));
-    QDomNode xml = test.toXml();
-    TestCollection_vector_string dest;
-    QBENCHMARK{
-        dest.fromXml(QSerializer::toByteArray(xml));
-    }
-}
+void Bench::toRawXml_data() { addRows(); }
+void Bench::toRawXml() { run(ToRawXml); }
 
-void Bench::bench_object_field_toJson() {
-    TestObject_field test;
+void Bench::fromXml_data() { addRows(); }
+void Bench::fromXml() { run(FromXml); }
 
-    test.f_object.f_int = 999;
-    test.f_object.f_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-    for(int i = 0; i< 100; i++)
-    {
-        test.f_object.v_int.append(i);
-        test.f_object.v_string.append(QString::number(i));
-    }
-    QBENCHMARK{
-        test.toJson();
-    }
-}
+void Bench::fromRawXml_data() { addRows(); }
+void Bench::fromRawXml() { run(FromRawXml); }
 
-void Bench::bench_object_field_toXml() {
-    TestObject_field test;
 
-    test.f_object.f_int = 999;
-    test.f_object.f_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-    for(int i = 0; i< 100; i++)
-    {
-        test.f_object.v_int.append(i);
-        test.f_object.v_string.append(QString::number(i));
-    }
-    QBENCHMARK{
-        test.toXml();
-    }
-}
-
-void Bench::bench_object_field_fromJson() {
-    TestObject_field test;
-
-    test.f_object.f_int = 999;
-    test.f_object.f_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-    for(int i = 0; i< 100; i++)
-    {
-        test.f_object.v_int.append(i);
-        test.f_object.v_string.append(QString::number(i));
-    }
-    QJsonObject json = test.toJson();
-    TestObject_field dest;
-    QBENCHMARK{
-        dest.fromJson(json);
-    }
-}
-
-void Bench::bench_object_field_fromXml() {
-    TestObject_field test;
-
-    test.f_object.f_int = 999;
-    test.f_object.f_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-    for(int i = 0; i< 100; i++)
-    {
-        test.f_object.v_int.append(i);
-        test.f_object.v_string.append(QString::number(i));
-    }
-
-    QDomNode xml = test.toXml();
-    TestObject_field dest;
-    QBENCHMARK{
-        dest.fromXml(QSerializer::toByteArray(xml));
-    }
-}
-
-void Bench::bench_collection_objects_toJson() {
+// Elements carrying long strings and vectors, so that copying an element
+// instead of constructing it in place shows up in the allocation count.
+static TestObject_collection makeHeavyCollection() {
     TestObject_collection test;
     for(int i = 0; i < 100; i++)
     {
         Object obj;
-        obj.f_int = 999;
-        obj.f_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-        for(int i = 0; i< 100; i++)
+        obj.f_int = i;
+        obj.f_string = QString(1024, QChar('x'));
+        for(int j = 0; j < 100; j++)
         {
-            obj.v_int.append(i);
-            obj.v_string.append(QString::number(i));
+            obj.v_int.append(j);
+            obj.v_string.append(QString(64, QChar('y')));
         }
         test.vector_object.append(obj);
     }
-    QBENCHMARK{
-        test.toJson();
-    }
+    return test;
 }
 
-void Bench::bench_collection_objects_toXml() {
-    TestObject_collection test;
-    for(int i = 0; i < 100; i++)
-    {
-        Object obj;
-        obj.f_int = 999;
-        obj.f_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-        for(int i = 0; i< 100; i++)
-        {
-            obj.v_int.append(i);
-            obj.v_string.append(QString::number(i));
-        }
-        test.vector_object.append(obj);
-    }
-    QBENCHMARK{
-        test.toXml();
-    }
-}
-
-void Bench::bench_collection_objects_fromJson() {
-    TestObject_collection test;
-    for(int i = 0; i < 100; i++)
-    {
-        Object obj;
-        obj.f_int = 999;
-        obj.f_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-        for(int i = 0; i< 100; i++)
-        {
-            obj.v_int.append(i);
-            obj.v_string.append(QString::number(i));
-        }
-        test.vector_object.append(obj);
-    }
-    QJsonObject json = test.toJson();
+void Bench::bench_collection_objects_fromJson_allocations() {
+    QJsonObject json = makeHeavyCollection().toJson();
     TestObject_collection dest;
-    QBENCHMARK{
-        dest.fromJson(json);
-    }
+    std::size_t before = AllocCounter::allocations();
+    dest.fromJson(json);
+    QTest::setBenchmarkResult(AllocCounter::allocations() - before, QTest::Events);
 }
 
-void Bench::bench_collection_objects_fromXml() {
-    TestObject_collection test;
-    for(int i = 0; i < 100; i++)
-    {
-        Object obj;
-        obj.f_int = 999;
-        obj.f_string = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
-        for(int i = 0; i< 5; i++)
-        {
-            obj.v_int.append(i);
-            obj.v_string.append(QString::number(i));
-        }
-        test.vector_object.append(obj);
-    }
-    QDomNode xml = test.toXml();
+void Bench::bench_collection_objects_fromXml_allocations() {
+    QDomNode xml = makeHeavyCollection().toXml();
     TestObject_collection dest;
-    QBENCHMARK{
-        dest.fromXml(xml);
-    }
+    std::size_t before = AllocCounter::allocations();
+    dest.fromXml(xml);
+    QTest::setBenchmarkResult(AllocCounter::allocations() - before, QTest::Events);
 }
-
-
-
-QTEST_MAIN(Bench);
@@ -2,79 +2,74 @@
 #define BENCH_H
 #include <QObject>
 #include <QTest>
+#include <functional>
 #include "testclasses.h"
 
+/* Every operation runs over all cases of benchCases() at every size of
+   benchSizes(); rows are tagged "<case>/<size>". */
 class Bench : public QObject {
 Q_OBJECT
-private Q_SLOTS:
-    //========================================================================================================================================
-    void bench_field_int_toJson();
-
-    void bench_field_int_toXml();
-
-    void bench_field_int_fromJson();
-
-    void bench_field_int_fromXml();
-    //========================================================================================================================================
-
+public:
+    enum Op {
+        ToJson,
+        ToRawJson,
+        FromJson,
+        FromRawJson,
+        ToXml,
+        ToRawXml,
+        FromXml,
+        FromRawXml
+    };
+
+    static const char* opName(Op op);
+
+    /* Operation op as a callable: serializes src, or deserializes what src
+       serializes to into dest. *payload receives the serialized size. */
+    static std::function<void()> operation(Op op, QSerializer& src,
+                                           QSerializer& dest, qint64* payload);
 
-
-    //========================================================================================================================================
-    void bench_field_string_toJson();
-
-    void bench_field_string_toXml();
-
-    void bench_field_string_fromJson();
-
-    void bench_field_string_fromXml();
-    //========================================================================================================================================
-
-
-
-    //========================================================================================================================================
-    void bench_collection_vector_int_toJson();
-
-    void bench_collection_vector_int_toXml();
-
-    void bench_collection_vector_int_fromJson();
-
-    void bench_collection_vector_int_fromXml();
+private Q_SLOTS:
     //========================================================================================================================================
+    void toJson_data();
+    void toJson();
 
+    void toRawJson_data();
+    void toRawJson();
 
+    void fromJson_data();
+    void fromJson();
 
+    void fromRawJson_data();
+    void fromRawJson();
     //========================================================================================================================================
-    void bench_collection_vector_string_toJson();
-
-    void bench_collection_vector_string_toXml();
 
-    void bench_collection_vector_string_fromJson();
-
-    void bench_collection_vector_string_fromXml();
-    //========================================================================================================================================
 
 
     //========================================================================================================================================
-    void bench_object_field_toJson();
+    void toXml_data();
+    void toXml();
 
-    void bench_object_field_toXml();
+    void toRawXml_data();
+    void toRawXml();
 
-    void bench_object_field_fromJson();
+    void fromXml_data();
+    void fromXml();
 
-    void bench_object_field_fromXml();
+    void fromRawXml_data();
+    void fromRawXml();
     //========================================================================================================================================
 
 
 
     //========================================================================================================================================
-    void bench_collection_objects_toJson();
-
-    void bench_collection_objects_toXml();
+    void bench_collection_objects_fromJson_allocations();
 
-    void bench_collection_objects_fromJson();
-    void bench_collection_objects_fromXml();
+    void bench_collection_objects_fromXml_allocations();
     //========================================================================================================================================
 
+private:
+    void addRows();
+    void run(Op op);
 };
 
 #endif // BENCH_H
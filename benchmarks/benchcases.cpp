@@ -0,0 +1,245 @@
+#include "benchcases.h"
+#include "generator.h"
+#include "report.h"
+#include <QHash>
+#include <cmath>
+
+static const char* const kString = "QWERTYUIOP{ASDFGHJKL:ZXCVBNM<>?";
+
+static bool s_generated = false;
+static quint64 s_seed = 0;
+
+void useGeneratedData(quint64 seed) {
+    s_generated = true;
+    s_seed = seed;
+}
+
+bool generatedData() { return s_generated; }
+
+static void fillObject(Object& obj, int index, int length) {
+    obj.f_int = index;
+    obj.f_string = kString;
+    for (int i = 0; i < length; i++) {
+        obj.v_int.append(i);
+        obj.v_string.append(QString::number(i));
+    }
+}
+
+/* Readings with the full precision of a double, as sensors deliver them */
+static double reading(int i) {
+    return 100 * std::sin(0.001 * i) + 0.5 * std::cos(i);
+}
+
+/* Channels per telemetry frame */
+static const int kChannels = 8;
+
+static void fillFrame(TelemetryFrame& frame, int index) {
+    frame.timestamp = 1700000000000LL + 20 * qint64(index);
+    frame.latitude = 59.93 + 1e-6 * index;
+    frame.longitude = 30.31 - 1e-6 * index;
+    frame.temperature = float(21.5 + 0.01 * (index % 300));
+    frame.channels.reserve(kChannels);
+    for (int c = 0; c < kChannels; c++)
+        frame.channels.append(reading(index * kChannels + c));
+}
+
+static void fillSkip(TestSkip& obj, int index) {
+    obj.s_value = QString::number(index);
+    obj.s_null_literal = "null";
+    obj.s_values = {index, index + 1, index + 2};
+}
+
+template <typename T>
+static std::unique_ptr<QSerializer> create() {
+    return std::unique_ptr<QSerializer>(new T);
+}
+
+template <typename T>
+static BenchCase makeCase(const QString& name, bool sized,
+                          std::function<void(T&, int)> fill,
+                          std::function<qint64(int)> objects) {
+    BenchCase c;
+    c.name = name;
+    c.sized = sized;
+    /* values of the generated instances by size */
+    std::shared_ptr<QHash<int, qint64>> values(new QHash<int, qint64>);
+    c.make = [fill, values](int size) {
+        std::unique_ptr<T> obj(new T);
+        if (s_generated) {
+            DataGenerator generator(s_seed);
+            generator.fill(*obj, size);
+            values->insert(size, generator.values());
+        } else {
+            fill(*obj, size);
+        }
+        return std::unique_ptr<QSerializer>(std::move(obj));
+    };
+    c.create = create<T>;
+    c.objects = [objects, values](int size) {
+        return s_generated ? values->value(size, objects(size))
+                           : objects(size);
+    };
+    return c;
+}
+
+/* Objects filled by fillObject with `length` elements per vector */
+static qint64 objectCount(int length) { return 1 + 2 * qint64(length); }
+
+static qint64 one(int) { return 1; }
+static qint64 perElement(int size) { return size; }
+static qint64 perObject(int size) { return size * objectCount(4); }
+static qint64 perFrame(int size) { return size * qint64(1 + kChannels); }
+
+static QVector<BenchCase> buildCases() {
+    QVector<BenchCase> cases;
+
+    cases.append(makeCase<TestField_int>(
+        "field_int", false, [](TestField_int& t, int) { t.field_int = 999; },
+        one));
+    cases.append(makeCase<TestField_string>(
+        "field_string", false,
+        [](TestField_string& t, int) { t.field_string = kString; }, one));
+    cases.append(makeCase<TestField_opt>(
+        "field_opt", false,
+        [](TestField_opt& t, int) { t.opt_string = QString(kString); }, one));
+
+    cases.append(makeCase<TestCollection_vector_int>(
+        "vector_int", true,
+        [](TestCollection_vector_int& t, int size) {
+            t.vector_int.reserve(size);
+            for (int i = 0; i < size; i++)
+                t.vector_int.append(i);
+        },
+        perElement));
+    cases.append(makeCase<TestCollection_vector_string>(
+        "vector_string", true,
+        [](TestCollection_vector_string& t, int size) {
+            t.vector_string.reserve(size);
+            for (int i = 0; i < size; i++)
+                t.vector_string.append(QString::number(i));
+        },
+        perElement));
+
+    cases.append(makeCase<TestCollection_vector_double>(
+        "vector_double", true,
+        [](TestCollection_vector_double& t, int size) {
+            t.vector_double.reserve(size);
+            for (int i = 0; i < size; i++)
+                t.vector_double.append(reading(i));
+        },
+        perElement));
+    cases.append(makeCase<TestCollection_vector_double_packed>(
+        "vector_double_packed", true,
+        [](TestCollection_vector_double_packed& t, int size) {
+            t.vector_double.reserve(size);
+            for (int i = 0; i < size; i++)
+                t.vector_double.append(reading(i));
+        },
+        perElement));
+    cases.append(makeCase<TestTelemetry>(
+        "telemetry", true,
+        [](TestTelemetry& t, int size) {
+            t.frames.reserve(size);
+            for (int i = 0; i < size; i++) {
+                TelemetryFrame frame;
+                fillFrame(frame, i);
+                t.frames.append(frame);
+            }
+        },
+        perFrame));
+
+    cases.append(makeCase<TestObject_field>(
+        "object", true,
+        [](TestObject_field& t, int size) {
+            fillObject(t.f_object, 999, size);
+        },
+        objectCount));
+    cases.append(makeCase<TestObject_opt>(
+        "object_opt", true,
+        [](TestObject_opt& t, int size) {
+            Object obj;
+            fillObject(obj, 999, size);
+            t.opt_object = obj;
+        },
+        objectCount));
+    cases.append(makeCase<TestObject_collection>(
+        "vector_object", true,
+        [](TestObject_collection& t, int size) {
+            t.vector_object.reserve(size);
+            for (int i = 0; i < size; i++) {
+                Object obj;
+                fillObject(obj, i, 4);
+                t.vector_object.append(obj);
+            }
+        },
+        perObject));
+
+    cases.append(makeCase<TestDict_qt>(
+        "qt_dict", true,
+        [](TestDict_qt& t, int size) {
+            for (int i = 0; i < size; i++)
+                t.qt_map.insert(QString("key%1").arg(i), kString);
+        },
+        perElement));
+    cases.append(makeCase<TestDict_qt_objects>(
+        "qt_dict_objects", true,
+        [](TestDict_qt_objects& t, int size) {
+            for (int i = 0; i < size; i++) {
+                Object obj;
+                fillObject(obj, i, 4);
+                t.qt_map_objects.insert(QString("key%1").arg(i), obj);
+            }
+        },
+        perObject));
+    cases.append(makeCase<TestDict_stl>(
+        "stl_dict", true,
+        [](TestDict_stl& t, int size) {
+            for (int i = 0; i < size; i++)
+                t.std_map.emplace(i, kString);
+        },
+        perElement));
+    cases.append(makeCase<TestDict_stl_objects>(
+        "stl_dict_objects", true,
+        [](TestDict_stl_objects& t, int size) {
+            for (int i = 0; i < size; i++) {
+                Object obj;
+                fillObject(obj, i, 4);
+                t.std_map_objects.emplace(QString("key%1").arg(i), obj);
+            }
+        },
+        perObject));
+
+    cases.append(makeCase<TestSkip_collection>(
+        "skip_options", true,
+        [](TestSkip_collection& t, int size) {
+            t.vector_skip.reserve(size);
+            for (int i = 0; i < size; i++) {
+                TestSkip obj;
+                fillSkip(obj, i);
+                t.vector_skip.append(obj);
+            }
+        },
+        perElement));
+
+    return cases;
+}
+
+const QVector<BenchCase>& benchCases() {
+    static const QVector<BenchCase> cases = buildCases();
+    return cases;
+}
+
+const BenchCase* findBenchCase(const QString& name) {
+    for (const BenchCase& c : benchCases()) {
+        if (c.name == name)
+            return &c;
+    }
+    return nullptr;
+}
+
+QVector<int> benchSizes() {
+    QVector<int> sizes;
+    for (qint64 size = 1; size <= BenchReport::instance().maxSize(); size *= 10)
+        sizes.append(int(size));
+    return sizes;
+}
@@ -0,0 +1,35 @@
+#ifndef BENCHCASES_H
+#define BENCHCASES_H
+#include "testclasses.h"
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <memory>
+
+/* One kind of payload of the suite. `size` is the number of collection
+   elements or dictionary entries; cases that are not sized ignore it. */
+struct BenchCase {
+    QString name;
+    bool sized = true;
+    /* Filled instance of the payload */
+    std::function<std::unique_ptr<QSerializer>(int size)> make;
+    /* Empty instance to deserialize into */
+    std::function<std::unique_ptr<QSerializer>()> create;
+    /* Objects and collection elements serialized per operation */
+    std::function<qint64(int size)> objects;
+};
+
+/* All payload kinds, one per field kind the library supports */
+const QVector<BenchCase>& benchCases();
+
+const BenchCase* findBenchCase(const QString& name);
+
+/* Fill the cases with DataGenerator data seeded with `seed` instead of the
+   fixed short strings and sequential numbers */
+void useGeneratedData(quint64 seed);
+bool generatedData();
+
+/* 1, 10, 100, ... up to BenchReport::maxSize() */
+QVector<int> benchSizes();
+
+#endif // BENCHCASES_H
@@ -1,6 +1,6 @@
 QT -= gui
 QT += testlib
-CONFIG += c++11 console
+CONFIG += c++17 console
 CONFIG -= app_bundle
 
 # The following define makes your compiler emit warnings if you use
@@ -14,16 +14,36 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+DEFINES += QS_HAS_JSON
+DEFINES += QS_HAS_XML
+
 SOURCES += \
-        bench.cpp
+        alloccounter.cpp \
+        baseline.cpp \
+        bench.cpp \
+        benchcases.cpp \
+        generator.cpp \
+        main.cpp \
+        memory.cpp \
+        perfcounters.cpp \
+        report.cpp \
+        scaling.cpp
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
-include(../src/QSerializer.pri)
+include(../qserializer.pri)
 
 HEADERS += \
+    alloccounter.h \
+    baseline.h \
     bench.h \
+    benchcases.h \
+    generator.h \
+    memory.h \
+    perfcounters.h \
+    report.h \
+    scaling.h \
     testclasses.h
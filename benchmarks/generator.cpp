@@ -0,0 +1,321 @@
+#include "generator.h"
+#include <QJsonArray>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+
+/* Probing follows nested objects this deep, so recursive classes end */
+static const int kMaxProbeDepth = 8;
+/* Collections nested in this many other collections are left empty */
+static const int kMaxNesting = 3;
+
+static QJsonValue valueAt(const QJsonValue& root, const QStringList& path,
+                          int i = 0) {
+    if (i == path.size())
+        return root;
+    if (root.isArray())
+        return valueAt(root.toArray().at(path[i].toInt()), path, i + 1);
+    return valueAt(root.toObject().value(path[i]), path, i + 1);
+}
+
+static QJsonValue replaceAt(const QJsonValue& root, const QStringList& path,
+                            const QJsonValue& value, int i = 0) {
+    if (i == path.size())
+        return value;
+    if (root.isArray()) {
+        QJsonArray array = root.toArray();
+        int index = path[i].toInt();
+        array.replace(index, replaceAt(array.at(index), path, value, i + 1));
+        return array;
+    }
+    QJsonObject object = root.toObject();
+    object.insert(path[i], replaceAt(object.value(path[i]), path, value,
+                                     i + 1));
+    return object;
+}
+
+/* Finds field shapes by writing probe values into one place of the
+   document and reading back what the setter made of them: an int field
+   turns 1.5 into 1, a string field into "1.5", a dictionary keyed by
+   numbers turns key "k" into "0", and so on. */
+class ShapeProbe {
+public:
+    explicit ShapeProbe(QSerializer& obj) : m_obj(obj) {
+        // skipped members would be invisible to the probe
+        m_ctx.setDefaultOptions(QSerializer::Options());
+        m_root = m_obj.toJson(m_ctx);
+    }
+
+    FieldShape shape(const QStringList& path, int depth) {
+        FieldShape shape;
+        if (depth > kMaxProbeDepth)
+            return shape;
+        QJsonValue current = valueAt(m_root, path);
+        if (current.isBool()) {
+            shape.kind = FieldShape::Bool;
+        } else if (current.isString()) {
+            shape.kind = FieldShape::String;
+        } else if (current.isDouble()) {
+            shape.kind = scalarKind(probe(path, 1.5));
+        } else if (current.isNull()) {
+            shape.optional = true;
+            if (probe(path, QJsonObject()).isObject()) {
+                commit();
+                return object(path, depth, std::move(shape));
+            }
+            shape.kind = scalarKind(probe(path, 1.5));
+        } else if (current.isArray()) {
+            QJsonArray array = probe(path, QJsonArray{1.5}).toArray();
+            if (array.isEmpty())
+                return shape;
+            commit();
+            shape.kind = FieldShape::Array;
+            shape.children.push_back(this->shape(path + QStringList("0"),
+                                                 depth + 1));
+        } else if (current.isObject()) {
+            if (path.isEmpty() || !probe(path, QJsonObject()).toObject()
+                                       .isEmpty())
+                return object(path, depth, std::move(shape));
+            return dict(path, depth, std::move(shape));
+        }
+        if (!path.isEmpty() && shape.kind != FieldShape::Array &&
+            probe(path, QJsonValue()).isNull())
+            shape.optional = true;
+        return shape;
+    }
+
+private:
+    /* Value at path after writing probe there */
+    QJsonValue probe(const QStringList& path, const QJsonValue& probe) {
+        m_obj.fromJson(replaceAt(m_root, path, probe));
+        m_probed = m_obj.toJson(m_ctx);
+        return valueAt(m_probed, path);
+    }
+
+    /* Keep the last probe, so its elements can be probed in turn */
+    void commit() { m_root = m_probed; }
+
+    static FieldShape::Kind scalarKind(const QJsonValue& value) {
+        if (value.isBool())
+            return FieldShape::Bool;
+        if (value.isString())
+            return FieldShape::String;
+        if (value.isDouble())
+            return value.toDouble() == 1.5 ? FieldShape::Double
+                                           : FieldShape::Int;
+        return FieldShape::Unknown;
+    }
+
+    FieldShape object(const QStringList& path, int depth, FieldShape shape) {
+        shape.kind = FieldShape::Object;
+        const QStringList names = valueAt(m_root, path).toObject().keys();
+        for (const QString& name : names) {
+            FieldShape member = this->shape(path + QStringList(name),
+                                            depth + 1);
+            if (member.kind == FieldShape::Unknown)
+                continue;
+            shape.names.append(name);
+            shape.children.push_back(std::move(member));
+        }
+        return shape;
+    }
+
+    FieldShape dict(const QStringList& path, int depth, FieldShape shape) {
+        QJsonObject dict = probe(path, QJsonObject{{"k", 1.5}}).toObject();
+        if (dict.isEmpty()) {
+            // a class without fields
+            shape.kind = FieldShape::Object;
+            return shape;
+        }
+        commit();
+        shape.kind = FieldShape::Dict;
+        shape.intKeys = !dict.contains("k");
+        shape.children.push_back(this->shape(
+            path + QStringList(dict.constBegin().key()), depth + 1));
+        return shape;
+    }
+
+    QSerializer& m_obj;
+    QSerializer::SerializationContext m_ctx;
+    QJsonValue m_root;
+    QJsonValue m_probed;
+};
+
+const FieldShape& DataGenerator::shapeOf(QSerializer& obj) {
+    static std::unordered_map<std::type_index, std::unique_ptr<FieldShape>>
+        shapes;
+    std::unique_ptr<FieldShape>& shape = shapes[typeid(obj)];
+    if (!shape) {
+        ShapeProbe probe(obj);
+        shape.reset(new FieldShape(probe.shape(QStringList(), 0)));
+    }
+    return *shape;
+}
+
+void DataGenerator::fill(QSerializer& obj, int size) {
+    obj.fromJson(generate(obj, size));
+}
+
+QJsonObject DataGenerator::generate(QSerializer& obj, int size) {
+    m_values = 1;
+    return object(shapeOf(obj), 0, size);
+}
+
+QJsonObject DataGenerator::object(const FieldShape& shape, int nesting,
+                                  int size) {
+    QJsonObject object;
+    for (std::size_t i = 0; i < shape.children.size(); i++)
+        object.insert(shape.names[int(i)],
+                      value(shape.children[i], nesting, size));
+    return object;
+}
+
+/* size >= 0 on the path from the root through objects only; elsewhere the
+   collection sizes are drawn */
+QJsonValue DataGenerator::value(const FieldShape& shape, int nesting,
+                                int size) {
+    if (shape.optional && size < 0 && chance(0.6))
+        return QJsonValue();
+    switch (shape.kind) {
+    case FieldShape::Bool:
+        return chance(0.5);
+    case FieldShape::Int:
+        return integer();
+    case FieldShape::Double:
+        return real();
+    case FieldShape::String:
+        return string();
+    case FieldShape::Object:
+        return object(shape, nesting, size);
+    case FieldShape::Array: {
+        QJsonArray array;
+        const FieldShape& element = shape.children.front();
+        int count = size >= 0 ? size
+                              : nesting < kMaxNesting ? collectionSize() : 0;
+        if (element.kind == FieldShape::Unknown)
+            count = 0;
+        for (int i = 0; i < count; i++) {
+            m_values++;
+            array.append(value(element, nesting + 1, -1));
+        }
+        return array;
+    }
+    case FieldShape::Dict: {
+        QJsonObject dict;
+        const FieldShape& element = shape.children.front();
+        int count = size >= 0 ? size
+                              : nesting < kMaxNesting ? collectionSize() : 0;
+        if (element.kind == FieldShape::Unknown)
+            count = 0;
+        while (dict.size() < count) {
+            QString k = shape.intKeys ? QString::number(integer()) : key();
+            if (dict.contains(k))
+                continue;
+            m_values++;
+            dict.insert(k, value(element, nesting + 1, -1));
+        }
+        return dict;
+    }
+    case FieldShape::Unknown:
+        break;
+    }
+    return QJsonValue();
+}
+
+/* splitmix64; std:: distributions differ between standard libraries, so
+   everything below is built on this alone */
+quint64 DataGenerator::next() {
+    quint64 z = (m_state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+quint32 DataGenerator::below(quint32 bound) {
+    return quint32(((next() >> 32) * bound) >> 32);
+}
+
+bool DataGenerator::chance(double probability) {
+    return double(next() >> 11) * 0x1.0p-53 < probability;
+}
+
+/* Most collections are short, a few are long */
+int DataGenerator::collectionSize() {
+    quint32 bucket = below(100);
+    if (bucket < 75)
+        return int(below(4));
+    if (bucket < 97)
+        return 4 + int(below(13));
+    return 17 + int(below(112));
+}
+
+int DataGenerator::integer() {
+    quint32 bucket = below(100);
+    if (bucket < 50)
+        return int(below(100));
+    if (bucket < 70)
+        return -int(below(1000));
+    if (bucket < 95)
+        return int(next() >> 32);
+    static const int kEdges[] = {0, -1, std::numeric_limits<int>::min(),
+                                 std::numeric_limits<int>::max()};
+    return kEdges[below(4)];
+}
+
+double DataGenerator::real() {
+    quint32 bucket = below(100);
+    double sign = chance(0.3) ? -1 : 1;
+    if (bucket < 40)
+        return sign * double(next() >> 11) * 0x1.0p-53;
+    if (bucket < 60)
+        return sign * double(below(100000)) / 100;
+    if (bucket < 90)
+        return sign * std::pow(10.0, double(below(60)) - 30) *
+               (1 + double(next() >> 11) * 0x1.0p-53);
+    return sign * std::pow(10.0, double(below(600)) - 300);
+}
+
+/* Mostly ASCII with escapes, accented Latin, Cyrillic, CJK and emoji
+   (surrogate pairs); lengths from empty to 2K characters */
+QString DataGenerator::string() {
+    quint32 bucket = below(100);
+    int length = bucket < 80   ? int(below(17))
+                 : bucket < 98 ? 16 + int(below(113))
+                               : 256 + int(below(1793));
+    static const char kEscapes[] = "\"\\/\b\f\n\r\t\x01\x1f";
+    QString str;
+    str.reserve(length + length / 8);
+    for (int i = 0; i < length; i++) {
+        quint32 kind = below(100);
+        if (kind < 70) {
+            str.append(QChar(ushort(0x20 + below(0x5f))));
+        } else if (kind < 75) {
+            str.append(QChar(ushort(kEscapes[below(sizeof(kEscapes) - 1)])));
+        } else if (kind < 85) {
+            str.append(QChar(ushort(0xc0 + below(0x40))));
+        } else if (kind < 92) {
+            str.append(QChar(ushort(0x410 + below(0x40))));
+        } else if (kind < 97) {
+            str.append(QChar(ushort(0x4e00 + below(0x5000))));
+        } else {
+            uint emoji = 0x1f600 + below(0x50);
+            str.append(QChar(QChar::highSurrogate(emoji)));
+            str.append(QChar(QChar::lowSurrogate(emoji)));
+        }
+    }
+    return str;
+}
+
+/* Identifier-like dictionary keys */
+QString DataGenerator::key() {
+    static const char kChars[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+    int length = 4 + int(below(21));
+    QString str;
+    str.reserve(length);
+    for (int i = 0; i < length; i++)
+        str.append(QChar(ushort(kChars[below(sizeof(kChars) - 1)])));
+    return str;
+}
@@ -0,0 +1,62 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+#include "../src/qserializer.h"
+#include <QJsonObject>
+#include <QStringList>
+#include <vector>
+
+/* What the JSON form of one declared field looks like, found by probing the
+   class through toJson / fromJson */
+struct FieldShape {
+    enum Kind { Unknown, Bool, Int, Double, String, Object, Array, Dict };
+    Kind kind = Unknown;
+    /* Written as null when unset (optional fields) */
+    bool optional = false;
+    /* Dictionary keys are numbers */
+    bool intKeys = false;
+    /* Object: one entry per member, named by `names`. Array, Dict: the
+       element shape as the only entry. */
+    std::vector<FieldShape> children;
+    QStringList names;
+};
+
+/* Deterministic generator of realistic payloads: long and Unicode strings
+   with escapes, large and negative numbers, sparse optionals and skewed
+   collection sizes. The same seed gives the same data on every platform. */
+class DataGenerator {
+public:
+    explicit DataGenerator(quint64 seed = 1) : m_state(seed) {}
+
+    /* Replace every declared field of obj with generated values. The
+       collections reached from obj through objects only get exactly `size`
+       elements; nested ones get skewed random sizes. */
+    void fill(QSerializer& obj, int size);
+
+    /* The document fill() deserializes */
+    QJsonObject generate(QSerializer& obj, int size);
+
+    /* Objects and collection elements in the last generated document */
+    qint64 values() const { return m_values; }
+
+    /* Shape of obj's class; probes obj, so its fields are overwritten. The
+       result is cached per class. */
+    static const FieldShape& shapeOf(QSerializer& obj);
+
+private:
+    QJsonValue value(const FieldShape& shape, int nesting, int size);
+    QJsonObject object(const FieldShape& shape, int nesting, int size);
+
+    quint64 next();
+    quint32 below(quint32 bound);
+    bool chance(double probability);
+    int collectionSize();
+    int integer();
+    double real();
+    QString string();
+    QString key();
+
+    quint64 m_state;
+    qint64 m_values = 0;
+};
+
+#endif // GENERATOR_H
@@ -0,0 +1,114 @@
+#include "alloccounter.h"
+#include "baseline.h"
+#include "bench.h"
+#include "benchcases.h"
+#include "memory.h"
+#include "report.h"
+#include "scaling.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+
+/* Besides the usual QTest arguments the suite accepts:
+     --json <file>      write all results to <file> as JSON
+     --max-size <n>     largest collection size of the parametrized cases
+     --perf             read hardware counters (Linux perf_event_open)
+     --repeat <n>       run the suite n times and report medians
+     --baseline <file>  compare with a report written by --json and fail
+                        when a case regressed
+     --threshold <pct>  regression threshold in percent, 5 by default
+     --scaling          run the width/depth/length sweeps instead, failing
+                        operations that grow faster than linear
+     --memory           run every operation once over large documents and
+                        report peak RSS and peak heap instead
+     --memory-size <n>  elements of the --memory documents, 100000 by
+                        default
+     --seed <n>         fill the cases with synthetic data generated from
+                        seed n: Unicode strings with escapes, large and
+                        negative numbers, sparse optionals, skewed nested
+                        collections
+     --profile <file>   write QSerializer::Profiler counters to <file>
+                        (builds with QS_ENABLE_PROFILING only) */
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QString jsonPath;
+    QString baselinePath;
+    QString profilePath;
+    int repeat = 1;
+    bool scaling = false;
+    bool memory = false;
+    double threshold = 5;
+    QStringList testArgs;
+    const QStringList args = app.arguments();
+    for (int i = 0; i < args.size(); i++) {
+        if (args[i] == "--json" && i + 1 < args.size())
+            jsonPath = args[++i];
+        else if (args[i] == "--max-size" && i + 1 < args.size())
+            BenchReport::instance().setMaxSize(args[++i].toInt());
+        else if (args[i] == "--perf")
+            BenchReport::instance().enablePerfCounters();
+        else if (args[i] == "--repeat" && i + 1 < args.size())
+            repeat = qMax(1, args[++i].toInt());
+        else if (args[i] == "--baseline" && i + 1 < args.size())
+            baselinePath = args[++i];
+        else if (args[i] == "--threshold" && i + 1 < args.size())
+            threshold = args[++i].toDouble();
+        else if (args[i] == "--scaling")
+            scaling = true;
+        else if (args[i] == "--memory")
+            memory = true;
+        else if (args[i] == "--memory-size" && i + 1 < args.size())
+            MemoryBench::setSize(args[++i].toInt());
+        else if (args[i] == "--profile" && i + 1 < args.size())
+            profilePath = args[++i];
+        else if (args[i] == "--seed" && i + 1 < args.size())
+            useGeneratedData(args[++i].toULongLong());
+        else
+            testArgs << args[i];
+    }
+
+    QVector<BenchSummary> baseline;
+    if (!baselinePath.isEmpty() && !loadBaseline(baselinePath, baseline))
+        return 1;
+
+#ifdef QS_ENABLE_PROFILING
+    QSerializer::Profiler::setAllocationCounter(
+        []() -> quint64 { return AllocCounter::allocations(); });
+#endif
+
+    Bench bench;
+    ScalingBench scalingBench;
+    MemoryBench memoryBench;
+    QObject* suite = &bench;
+    if (scaling)
+        suite = &scalingBench;
+    else if (memory)
+        suite = &memoryBench;
+    int rc = 0;
+    for (int i = 0; i < repeat; i++)
+        rc |= QTest::qExec(suite, testArgs);
+
+    BenchReport& report = BenchReport::instance();
+    if (!jsonPath.isEmpty() && !report.writeJson(jsonPath) && rc == 0)
+        rc = 1;
+    if (!profilePath.isEmpty()) {
+#ifdef QS_ENABLE_PROFILING
+        QFile file(profilePath);
+        if (!file.open(QIODevice::WriteOnly) ||
+            file.write(QSerializer::Profiler::dump()) < 0) {
+            qWarning() << "cannot write profile" << profilePath;
+            if (rc == 0)
+                rc = 1;
+        }
+#else
+        qWarning() << "--profile needs a build with QS_ENABLE_PROFILING";
+#endif
+    }
+    if (!baselinePath.isEmpty()) {
+        QVector<BenchSummary> current = summarize(report.results());
+        if (compareWithBaseline(current, baseline, threshold / 100) && rc == 0)
+            rc = 1;
+    }
+    return rc;
+}
@@ -0,0 +1,83 @@
+#include "memory.h"
+#include "alloccounter.h"
+#include "bench.h"
+#include "benchcases.h"
+#include "report.h"
+#include <QFile>
+#include <memory>
+
+int MemoryBench::s_size = 100000;
+
+/* A size field of /proc/self/status in bytes, -1 when unavailable */
+static qint64 statusField(const char* field) {
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    const QByteArray prefix = QByteArray(field) + ':';
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray& line : lines) {
+        if (line.startsWith(prefix))
+            return line.mid(prefix.size()).trimmed().split(' ').first()
+                       .toLongLong() * 1024;
+    }
+    return -1;
+}
+
+/* Make VmHWM restart from the current RSS (Linux 4.0 and later) */
+static bool resetPeakRss() {
+    QFile file("/proc/self/clear_refs");
+    return file.open(QIODevice::WriteOnly) && file.write("5") == 1;
+}
+
+void MemoryBench::peak_data() {
+    QTest::addColumn<QString>("caseName");
+    QTest::addColumn<int>("op");
+    for (const BenchCase& c : benchCases()) {
+        if (!c.sized)
+            continue;
+        for (int op = Bench::ToJson; op <= Bench::FromRawXml; op++) {
+            QString tag = QString("%1/%2").arg(c.name,
+                                               Bench::opName(Bench::Op(op)));
+            QTest::newRow(qPrintable(tag)) << c.name << op;
+        }
+    }
+}
+
+void MemoryBench::peak() {
+    QFETCH(QString, caseName);
+    QFETCH(int, op);
+    const BenchCase* c = findBenchCase(caseName);
+    QVERIFY(c);
+
+    // inputs are prepared before the baseline is taken
+    std::unique_ptr<QSerializer> src = c->make(s_size);
+    std::unique_ptr<QSerializer> dest = c->create();
+    qint64 payload = 0;
+    std::function<void()> call =
+        Bench::operation(Bench::Op(op), *src, *dest, &payload);
+
+    const bool rssTracked = resetPeakRss();
+    const qint64 rssBefore = statusField("VmRSS");
+    AllocCounter::resetPeak();
+    const std::size_t heapBefore = AllocCounter::liveBytes();
+
+    BenchRun run(c->name, Bench::opName(Bench::Op(op)), s_size, payload,
+                 c->objects(s_size));
+    const std::size_t allocations = AllocCounter::allocations();
+    const std::size_t allocatedBytes = AllocCounter::allocatedBytes();
+    call();
+    run.tick();
+
+    // the one call is both the timed and the counted one
+    run.setAllocations(
+        qint64(AllocCounter::allocations() - allocations),
+        qint64(AllocCounter::allocatedBytes() - allocatedBytes));
+
+    const std::size_t heapPeak = AllocCounter::peakBytes();
+    const qint64 rssPeak = statusField("VmHWM");
+    run.setPeakMemory(
+        rssTracked && rssBefore >= 0 && rssPeak >= 0 ? rssPeak - rssBefore
+                                                     : -1,
+        AllocCounter::tracksLiveBytes() ? qint64(heapPeak - heapBefore) : -1);
+    run.finish();
+}
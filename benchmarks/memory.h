@@ -0,0 +1,23 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+#include <QObject>
+#include <QTest>
+
+/* Runs every operation once over a large instance of every case and
+   reports how far peak RSS and peak heap rose above the level before the
+   call. Run with --memory; --memory-size sets the number of elements. */
+class MemoryBench : public QObject {
+Q_OBJECT
+public:
+    static int size() { return s_size; }
+    static void setSize(int size) { s_size = size; }
+
+private Q_SLOTS:
+    void peak_data();
+    void peak();
+
+private:
+    static int s_size;
+};
+
+#endif // MEMORY_H
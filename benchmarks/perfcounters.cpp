@@ -0,0 +1,93 @@
+#include "perfcounters.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int openEvent(std::uint32_t type, std::uint64_t config, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : m_fds) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+bool PerfCounters::open() {
+    if (isOpen())
+        return true;
+
+    static const std::uint64_t configs[EventCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+    for (int i = 0; i < EventCount; i++) {
+        m_fds[i] = openEvent(PERF_TYPE_HARDWARE, configs[i], m_fds[0]);
+        if (m_fds[i] < 0) {
+            m_error = std::strerror(errno);
+            for (int& fd : m_fds) {
+                if (fd >= 0)
+                    close(fd);
+                fd = -1;
+            }
+            return false;
+        }
+    }
+    m_leader = m_fds[0];
+    m_error = "";
+    return true;
+}
+
+void PerfCounters::start() {
+    if (!isOpen())
+        return;
+    for (std::uint64_t& value : m_values)
+        value = 0;
+    ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::stop() {
+    if (!isOpen())
+        return;
+    ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // { nr, time_enabled, time_running, value[nr] }
+    std::uint64_t data[3 + EventCount] = {};
+    if (read(m_leader, data, sizeof(data)) < ssize_t(sizeof(data)))
+        return;
+    double scale = data[2] ? double(data[1]) / data[2] : 1.0;
+    for (int i = 0; i < EventCount; i++)
+        m_values[i] = std::uint64_t(data[3 + i] * scale);
+}
+
+#else
+
+PerfCounters::~PerfCounters() {}
+
+bool PerfCounters::open() {
+    m_error = "perf_event_open is only available on Linux";
+    return false;
+}
+
+void PerfCounters::start() {}
+
+void PerfCounters::stop() {}
+
+#endif
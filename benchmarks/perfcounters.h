@@ -0,0 +1,35 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+#include <cstdint>
+
+/* Hardware counters of the calling thread read through Linux
+   perf_event_open. When the kernel does not allow it (other systems,
+   containers, perf_event_paranoid) open() fails and error() says why. */
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, CacheMisses, BranchMisses, EventCount };
+
+    PerfCounters() = default;
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool open();
+    bool isOpen() const { return m_leader >= 0; }
+    const char* error() const { return m_error; }
+
+    void start();
+    void stop();
+
+    /* Counted between the last start() and stop(), scaled up when the
+       kernel had to multiplex the counters */
+    std::uint64_t value(Event event) const { return m_values[event]; }
+
+private:
+    int m_leader = -1;
+    int m_fds[EventCount] = {-1, -1, -1, -1};
+    std::uint64_t m_values[EventCount] = {};
+    const char* m_error = "not opened";
+};
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,141 @@
+#include "report.h"
+#include "alloccounter.h"
+#include "baseline.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+double BenchResult::nsPerOp() const {
+    return iterations ? double(elapsedNs) / iterations : 0;
+}
+
+double BenchResult::mbPerSec() const {
+    return elapsedNs ? double(bytes) * iterations * 1e3 / elapsedNs : 0;
+}
+
+double BenchResult::objectsPerSec() const {
+    return elapsedNs ? double(objects) * iterations * 1e9 / elapsedNs : 0;
+}
+
+double BenchResult::ipc() const {
+    return cycles ? instructions / cycles : 0;
+}
+
+double BenchResult::cacheMissesPerObject() const {
+    return objects ? cacheMisses / objects : 0;
+}
+
+double BenchResult::branchMissesPerObject() const {
+    return objects ? branchMisses / objects : 0;
+}
+
+BenchReport& BenchReport::instance() {
+    static BenchReport report;
+    return report;
+}
+
+bool BenchReport::enablePerfCounters() {
+    if (m_perfCounters.open())
+        return true;
+    qWarning().noquote() << "hardware counters unavailable:"
+                         << m_perfCounters.error();
+    return false;
+}
+
+void BenchReport::add(const BenchResult& result) {
+    m_results.append(result);
+    qInfo().noquote() << QString::asprintf(
+        "%-22s %-12s %8d %14.1f ns/op %10.2f MB/s %14.0f objects/s "
+        "%10lld allocs/op %12lld B/op",
+        qPrintable(result.name), qPrintable(result.op), result.size,
+        result.nsPerOp(), result.mbPerSec(), result.objectsPerSec(),
+        result.allocations, result.allocatedBytes);
+    if (result.hasCounters) {
+        qInfo().noquote() << QString::asprintf(
+            "%-44s %14.0f cycles/op %10.0f instr/op %6.2f IPC "
+            "%10.3f cache-misses/object %10.3f branch-misses/object",
+            "", result.cycles, result.instructions, result.ipc(),
+            result.cacheMissesPerObject(), result.branchMissesPerObject());
+    }
+    if (result.peakRss >= 0 || result.peakHeap >= 0) {
+        qInfo().noquote() << QString::asprintf(
+            "%-44s %10.2f MiB peak RSS %10.2f MiB peak heap", "",
+            result.peakRss / 1048576.0, result.peakHeap / 1048576.0);
+    }
+}
+
+bool BenchReport::writeJson(const QString& path) const {
+    QJsonArray results;
+    for (const BenchSummary& summary : summarize(m_results))
+        results.append(summary.toJson());
+
+    QJsonObject root;
+    root["qt_version"] = QString(qVersion());
+    root["results"] = results;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "cannot write benchmark report" << path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+BenchRun::BenchRun(const QString& name, const QString& op, int size,
+                   qint64 bytes, qint64 objects) {
+    m_result.name = name;
+    m_result.op = op;
+    m_result.size = size;
+    m_result.bytes = bytes;
+    m_result.objects = objects;
+    m_counters = BenchReport::instance().perfCounters();
+    if (m_counters)
+        m_counters->start();
+    m_timer.start();
+}
+
+void BenchRun::stop() {
+    if (m_result.elapsedNs == 0) {
+        m_result.elapsedNs = m_timer.nsecsElapsed();
+        m_result.iterations = m_iterations;
+        if (m_counters && m_iterations) {
+            m_counters->stop();
+            double n = double(m_iterations);
+            m_result.hasCounters = true;
+            m_result.cycles = m_counters->value(PerfCounters::Cycles) / n;
+            m_result.instructions =
+                m_counters->value(PerfCounters::Instructions) / n;
+            m_result.cacheMisses =
+                m_counters->value(PerfCounters::CacheMisses) / n;
+            m_result.branchMisses =
+                m_counters->value(PerfCounters::BranchMisses) / n;
+        }
+    }
+}
+
+void BenchRun::countAllocations(const std::function<void()>& call) {
+    stop();
+    std::size_t allocations = AllocCounter::allocations();
+    std::size_t bytes = AllocCounter::allocatedBytes();
+    call();
+    m_result.allocations = qint64(AllocCounter::allocations() - allocations);
+    m_result.allocatedBytes = qint64(AllocCounter::allocatedBytes() - bytes);
+}
+
+void BenchRun::setAllocations(qint64 allocations, qint64 bytes) {
+    m_result.allocations = allocations;
+    m_result.allocatedBytes = bytes;
+}
+
+void BenchRun::setPeakMemory(qint64 rss, qint64 heap) {
+    m_result.peakRss = rss;
+    m_result.peakHeap = heap;
+}
+
+void BenchRun::finish() {
+    stop();
+    BenchReport::instance().add(m_result);
+}
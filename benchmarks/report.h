@@ -0,0 +1,101 @@
+#ifndef REPORT_H
+#define REPORT_H
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "perfcounters.h"
+
+/* One measured benchmark case: operation `op` of case `name` at `size` */
+struct BenchResult {
+    QString name;
+    QString op;
+    int size = 0;
+    qint64 iterations = 0;
+    qint64 elapsedNs = 0;
+    qint64 bytes = 0;   // serialized payload per operation
+    qint64 objects = 0; // objects and collection elements per operation
+    qint64 allocations = 0;    // heap allocations per operation
+    qint64 allocatedBytes = 0; // bytes requested from the heap per operation
+
+    // hardware counters per operation, when enabled with --perf
+    bool hasCounters = false;
+    double cycles = 0;
+    double instructions = 0;
+    double cacheMisses = 0;
+    double branchMisses = 0;
+
+    // rise above the level before the call, -1 when not measured (--memory)
+    qint64 peakRss = -1;
+    qint64 peakHeap = -1;
+
+    double nsPerOp() const;
+    double mbPerSec() const;
+    double objectsPerSec() const;
+    double ipc() const;
+    double cacheMissesPerObject() const;
+    double branchMissesPerObject() const;
+};
+
+/* Collects the results of a run and writes them as JSON, one entry per case
+   with the statistics of its repetitions */
+class BenchReport {
+public:
+    static BenchReport& instance();
+
+    /* Largest size used by the parametrized cases */
+    int maxSize() const { return m_maxSize; }
+    void setMaxSize(int size) { m_maxSize = size; }
+
+    /* Hardware counters around every timed loop; falls back to timing only
+       when the counters cannot be opened */
+    bool enablePerfCounters();
+    PerfCounters* perfCounters() {
+        return m_perfCounters.isOpen() ? &m_perfCounters : nullptr;
+    }
+
+    void add(const BenchResult& result);
+    const QVector<BenchResult>& results() const { return m_results; }
+
+    bool writeJson(const QString& path) const;
+
+private:
+    int m_maxSize = 1000000;
+    QVector<BenchResult> m_results;
+    PerfCounters m_perfCounters;
+};
+
+/* Times the iterations of one QBENCHMARK loop:
+
+       BenchRun run("field_int", "toJson", size, bytes, objects);
+       QBENCHMARK {
+           test.toJson();
+           run.tick();
+       }
+       run.countAllocations([&] { test.toJson(); });
+       run.finish();
+*/
+class BenchRun {
+public:
+    BenchRun(const QString& name, const QString& op, int size, qint64 bytes,
+             qint64 objects);
+
+    void tick() { ++m_iterations; }
+    /* Run the warmed-up operation once more and record its heap usage */
+    void countAllocations(const std::function<void()>& call);
+    /* Heap usage measured by the caller around a single call */
+    void setAllocations(qint64 allocations, qint64 bytes);
+    void setPeakMemory(qint64 rss, qint64 heap);
+    void finish();
+
+private:
+    /* End of the timed loop */
+    void stop();
+
+    BenchResult m_result;
+    qint64 m_iterations = 0;
+    QElapsedTimer m_timer;
+    PerfCounters* m_counters = nullptr;
+};
+
+#endif // REPORT_H
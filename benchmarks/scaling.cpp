@@ -0,0 +1,180 @@
+#include "scaling.h"
+#include "bench.h"
+#include "benchcases.h"
+#include "report.h"
+#include <QElapsedTimer>
+#include <cmath>
+#include <memory>
+
+typedef std::function<std::unique_ptr<QSerializer>(int n)> Factory;
+
+/* Every point is timed for at least this long, three times; the fastest of
+   the three is used for the fit */
+static const qint64 kMinTimeNs = 50 * 1000 * 1000;
+static const int kRepetitions = 3;
+
+static std::unique_ptr<QSerializer> makeWidth(int width) {
+    switch (width) {
+    case 8: return std::unique_ptr<QSerializer>(new TestWidth_8);
+    case 16: return std::unique_ptr<QSerializer>(new TestWidth_16);
+    case 32: return std::unique_ptr<QSerializer>(new TestWidth_32);
+    case 64: return std::unique_ptr<QSerializer>(new TestWidth_64);
+    case 128: return std::unique_ptr<QSerializer>(new TestWidth_128);
+    }
+    return nullptr;
+}
+
+static std::unique_ptr<QSerializer> makeChain(int depth) {
+    std::unique_ptr<TestDepth> root(new TestDepth);
+    TestDepth* node = root.get();
+    for (int i = 1; i < depth; i++) {
+        node->value = i;
+        node->next.append(TestDepth());
+        node = &node->next.last();
+    }
+    return std::unique_ptr<QSerializer>(std::move(root));
+}
+
+static double measure(const QString& sweep, Bench::Op op, int n,
+                      const Factory& make, const Factory& create) {
+    std::unique_ptr<QSerializer> src = make(n);
+    std::unique_ptr<QSerializer> dest = create(n);
+    qint64 payload = 0;
+    std::function<void()> call =
+        Bench::operation(op, *src, *dest, &payload);
+
+    double best = 0;
+    for (int rep = 0; rep < kRepetitions; rep++) {
+        BenchRun run(sweep, Bench::opName(op), n, payload, n);
+        QElapsedTimer timer;
+        timer.start();
+        do {
+            call();
+            run.tick();
+        } while (timer.nsecsElapsed() < kMinTimeNs);
+        run.countAllocations(call);
+        run.finish();
+
+        double ns = BenchReport::instance().results().last().nsPerOp();
+        best = rep == 0 ? ns : qMin(best, ns);
+    }
+    return best;
+}
+
+/* Exponent k of time = a + b * n^k, a >= 0. The constant absorbs the
+   fixed cost of a call, which would flatten a plain log-log fit at small n
+   and hide a quadratic term. Each k on a grid gets a least-squares a and b,
+   weighted by 1/time^2 so that the error is relative; the k with the
+   smallest error wins. */
+static double fitSlope(const QVector<int>& ns, const QVector<double>& times) {
+    double bestK = 0;
+    double bestError = -1;
+    for (int step = 0; step <= 300; step++) {
+        const double k = step / 100.0;
+        double sw = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (int i = 0; i < ns.size(); i++) {
+            double x = std::pow(double(ns[i]), k);
+            double w = 1 / (times[i] * times[i]);
+            sw += w;
+            sx += w * x;
+            sy += w * times[i];
+            sxx += w * x * x;
+            sxy += w * x * times[i];
+        }
+        double det = sw * sxx - sx * sx;
+        double a = 0, b = 0;
+        if (det > 0) {
+            a = (sxx * sy - sx * sxy) / det;
+            b = (sw * sxy - sx * sy) / det;
+        }
+        if (det <= 0 || a < 0) {
+            a = 0;
+            b = sxy / sxx;
+        }
+        if (b < 0)
+            continue;
+        double error = 0;
+        for (int i = 0; i < ns.size(); i++) {
+            double r = (times[i] - a - b * std::pow(double(ns[i]), k)) /
+                       times[i];
+            error += r * r;
+        }
+        if (bestError < 0 || error < bestError) {
+            bestError = error;
+            bestK = k;
+        }
+    }
+    return bestK;
+}
+
+static void sweep(const QString& name, const QVector<int>& ns,
+                  const Factory& make, const Factory& create) {
+    QFETCH(int, op);
+
+    QVector<double> times;
+    for (int n : ns)
+        times.append(measure(name, Bench::Op(op), n, make, create));
+
+    double slope = fitSlope(ns, times);
+    qInfo().noquote() << QString::asprintf(
+        "%s %s: time ~ a + b*n^%.2f over n = %d..%d", qPrintable(name),
+        Bench::opName(Bench::Op(op)), slope, ns.first(), ns.last());
+    QVERIFY2(slope <= ScalingBench::maxSlope(),
+             qPrintable(QString("%1 grows as n^%2, faster than linear")
+                            .arg(Bench::opName(Bench::Op(op)))
+                            .arg(slope, 0, 'f', 2)));
+}
+
+void ScalingBench::addOps() {
+    QTest::addColumn<int>("op");
+    for (int op = Bench::ToJson; op <= Bench::FromRawXml; op++)
+        QTest::newRow(Bench::opName(Bench::Op(op))) << op;
+}
+
+void ScalingBench::width_data() { addOps(); }
+
+void ScalingBench::width() {
+    sweep("scaling_width", {8, 16, 32, 64, 128}, makeWidth, makeWidth);
+}
+
+void ScalingBench::depth_data() { addOps(); }
+
+void ScalingBench::depth() {
+    sweep("scaling_depth", {4, 8, 16, 32, 64, 128}, makeChain,
+          [](int) { return std::unique_ptr<QSerializer>(new TestDepth); });
+}
+
+void ScalingBench::length_data() { addOps(); }
+
+void ScalingBench::length() {
+    const BenchCase* c = findBenchCase("vector_object");
+    QVERIFY(c);
+    sweep("scaling_length", {100, 1000, 10000, 100000}, c->make,
+          [c](int) { return c->create(); });
+}
+
+void ScalingBench::fit_data() {
+    QTest::addColumn<double>("fixed");
+    QTest::addColumn<double>("linear");
+    QTest::addColumn<double>("quadratic");
+    QTest::addColumn<bool>("passes");
+    QTest::newRow("linear") << 1e5 << 10.0 << 0.0 << true;
+    QTest::newRow("linear_no_overhead") << 0.0 << 10.0 << 0.0 << true;
+    QTest::newRow("quadratic") << 1e5 << 10.0 << 1.0 << false;
+    QTest::newRow("quadratic_no_overhead") << 0.0 << 0.0 << 1.0 << false;
+}
+
+/* The gate itself, on synthetic timings: a quadratic term hidden behind a
+   large fixed cost at small n must still fail */
+void ScalingBench::fit() {
+    QFETCH(double, fixed);
+    QFETCH(double, linear);
+    QFETCH(double, quadratic);
+    QFETCH(bool, passes);
+
+    const QVector<int> ns = {8, 16, 32, 64, 128};
+    QVector<double> times;
+    for (int n : ns)
+        times.append(fixed + linear * n + quadratic * n * n);
+    QCOMPARE(fitSlope(ns, times) <= maxSlope(), passes);
+}
@@ -0,0 +1,33 @@
+#ifndef SCALING_H
+#define SCALING_H
+#include <QObject>
+#include <QTest>
+
+/* Sweeps object width (fields per class), nesting depth and collection
+   length, fits time ~ a + b * n^k and fails any operation whose exponent k
+   exceeds ScalingBench::maxSlope(), i.e. that grows clearly faster than
+   linear. fit() checks the gate on synthetic quadratic timings. Run with
+   --scaling. */
+class ScalingBench : public QObject {
+Q_OBJECT
+public:
+    static double maxSlope() { return 1.25; }
+
+private Q_SLOTS:
+    void width_data();
+    void width();
+
+    void depth_data();
+    void depth();
+
+    void length_data();
+    void length();
+
+    void fit_data();
+    void fit();
+
+private:
+    void addOps();
+};
+
+#endif // SCALING_H
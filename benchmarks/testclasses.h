@@ -3,37 +3,60 @@
 
 #include "../src/qserializer.h"
 #include <QObject>
+#include <QMap>
+#include <QVector>
+#include <map>
 
-class TestField_int {
+class TestField_int : public QSerializer {
     Q_GADGET
-    QS_CLASS
+    QS_SERIALIZABLE
     QS_FIELD(int, field_int)
 };
 
-class TestField_string{
+class TestField_string : public QSerializer {
     Q_GADGET
-    QS_CLASS
+    QS_SERIALIZABLE
     QS_FIELD(QString, field_string)
 };
 
-class TestCollection_vector_int {
+class TestField_opt : public QSerializer {
     Q_GADGET
-    QS_CLASS
+    QS_SERIALIZABLE
+    QS_FIELD_OPT(int, opt_int)
+    QS_FIELD_OPT(QString, opt_string)
+};
+
+class TestCollection_vector_int : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
     QS_COLLECTION(QVector, int, vector_int)
 };
 
-class TestCollection_vector_string {
+class TestCollection_vector_string : public QSerializer {
     Q_GADGET
-    QS_CLASS
+    QS_SERIALIZABLE
     QS_COLLECTION(QVector, QString, vector_string)
 };
 
+class TestCollection_vector_double : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_COLLECTION(QVector, double, vector_double)
+};
+
+class TestCollection_vector_double_packed : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_COLLECTION(QVector, double, vector_double)
+    QS_INTERNAL_MEMBER_XML_NUMBERS(vector_double, Text)
+};
 
 
-class Object
+
+class Object : public QSerializer
 {
     Q_GADGET
-    QS_CLASS
+    QS_SERIALIZABLE
     QS_FIELD(int, f_int)
     QS_FIELD(QString, f_string)
     QS_COLLECTION(QVector, int, v_int)
@@ -41,18 +64,146 @@ class Object
 };
 
 
-class TestObject_field {
+class TestObject_field : public QSerializer {
     Q_GADGET
-    QS_CLASS
+    QS_SERIALIZABLE
     QS_OBJECT(Object, f_object)
 };
 
+class TestObject_opt : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_OBJECT_OPT(Object, opt_object)
+};
+
 
-class TestObject_collection{
+class TestObject_collection : public QSerializer {
     Q_GADGET
-    QS_CLASS
+    QS_SERIALIZABLE
     QS_COLLECTION_OBJECTS(QVector, Object, vector_object)
 };
 
 
+class TestDict_qt : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_QT_DICT(QMap, QString, QString, qt_map)
+};
+
+class TestDict_qt_objects : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_QT_DICT_OBJECTS(QMap, QString, Object, qt_map_objects)
+};
+
+class TestDict_stl : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_STL_DICT(std::map, int, QString, std_map)
+};
+
+class TestDict_stl_objects : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_STL_DICT_OBJECTS(std::map, QString, Object, std_map_objects)
+};
+
+
+// Half of the members are empty, null or "null" so that the skip options
+// have something to drop.
+class TestSkip : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_FIELD(QString, s_value)
+    QS_FIELD(QString, s_empty)
+    QS_FIELD(QString, s_null_literal)
+    QS_FIELD_OPT(int, s_unset)
+    QS_COLLECTION(QVector, int, s_values)
+    QS_COLLECTION(QVector, int, s_no_values)
+    QS_INTERNAL_SKIP_EMPTY_AND_NULL_LITERALS
+    QS_INTERNAL_MEMBER_SKIP_NULL(s_unset)
+};
+
+class TestSkip_collection : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_COLLECTION_OBJECTS(QVector, TestSkip, vector_skip)
+};
+
+
+// Numeric-heavy sensor frames: a timestamp, a position and a block of
+// channel readings each
+class TelemetryFrame : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_FIELD(qint64, timestamp)
+    QS_FIELD(double, latitude)
+    QS_FIELD(double, longitude)
+    QS_FIELD(float, temperature)
+    QS_COLLECTION(QVector, double, channels)
+};
+
+class TestTelemetry : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_COLLECTION_OBJECTS(QVector, TelemetryFrame, frames)
+};
+
+
+// Classes of growing width and a self-nesting class for the scaling
+// benchmarks
+#define BENCH_FIELDS_8(p)                                                  \
+    QS_FIELD(int, p##0) QS_FIELD(int, p##1) QS_FIELD(int, p##2)            \
+    QS_FIELD(int, p##3) QS_FIELD(int, p##4) QS_FIELD(int, p##5)            \
+    QS_FIELD(int, p##6) QS_FIELD(int, p##7)
+
+#define BENCH_FIELDS_64(p)                                                 \
+    BENCH_FIELDS_8(p##0) BENCH_FIELDS_8(p##1) BENCH_FIELDS_8(p##2)         \
+    BENCH_FIELDS_8(p##3) BENCH_FIELDS_8(p##4) BENCH_FIELDS_8(p##5)         \
+    BENCH_FIELDS_8(p##6) BENCH_FIELDS_8(p##7)
+
+class TestWidth_8 : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    BENCH_FIELDS_8(f)
+};
+
+class TestWidth_16 : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    BENCH_FIELDS_8(f)
+    BENCH_FIELDS_8(g)
+};
+
+class TestWidth_32 : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    BENCH_FIELDS_8(f)
+    BENCH_FIELDS_8(g)
+    BENCH_FIELDS_8(h)
+    BENCH_FIELDS_8(k)
+};
+
+class TestWidth_64 : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    BENCH_FIELDS_64(f)
+};
+
+class TestWidth_128 : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    BENCH_FIELDS_64(f)
+    BENCH_FIELDS_64(g)
+};
+
+// A chain of `depth` objects: every node holds at most one child
+class TestDepth : public QSerializer {
+    Q_GADGET
+    QS_SERIALIZABLE
+    QS_FIELD(int, value)
+    QS_COLLECTION_OBJECTS(QVector, TestDepth, next)
+};
+
+
 #endif // TESTCLASSES_H
@@ -45,21 +45,95 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QCborValue>
+#endif
 #endif
 
 /* XML */
 #ifdef QS_HAS_XML
+#include <QTextStream>
 #include <QtXml/QDomDocument>
 #include <QtXml/QDomElement>
 #endif
 
 /* META OBJECT SYSTEM */
 #include <QDebug>
+#include <QLocale>
 #include <QMetaObject>
 #include <QMetaProperty>
 #include <QMetaType>
 #include <QVariant>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* Monotonic arena for scratch allocations of the parse path (C++17) */
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#include <optional>
+#define QS_HAS_PMR
+#endif
+#endif
+#endif
+
+/* Number formatting and parsing without QVariant (C++17); shortest
+ * round-trip doubles where the library has floating-point to_chars */
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#define QS_HAS_CHARCONV
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define QS_HAS_FLOAT_CHARCONV
+#endif
+#endif
+#endif
+#endif
+
+/* Vector kernels of the JSON writer: SSE2 where the target has it, AVX2
+ * chosen at runtime with GCC and Clang. Define QS_NO_SIMD for the scalar
+ * code only. */
+#if !defined(QS_NO_SIMD) &&                                  \
+    (defined(__SSE2__) || defined(_M_X64) ||                 \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define QS_JSON_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define QS_JSON_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+/* Per-class call counters, latencies, bytes and allocations (opt-in) */
+#ifdef QS_ENABLE_PROFILING
+#include <array>
+#include <chrono>
+#endif
+
+/* Begin/end hooks around every field (opt-in) */
+#ifdef QS_ENABLE_TRACING
+#include <chrono>
+#endif
+
 #define QS_VERSION "1.2.3"
 
 /* Base class metaObject method implementation */
@@ -94,116 +168,2675 @@ Q_DECLARE_METATYPE(QDomElement)
 #define QS_JSON_DOC_MODE QJsonDocument::Compact // QJsonDocument::Indented
 #endif
 
+/* Record the enclosing call in QSerializer::Profiler; the raw variants also
+ * record the bytes produced or consumed. Compiled out unless
+ * QS_ENABLE_PROFILING is defined. */
+#ifdef QS_ENABLE_PROFILING
+#define QS_PROFILE(operation) \
+  ProfileScope qsProfileScope(this, Profiler::operation)
+#define QS_PROFILE_RAW(operation) \
+  QS_PROFILE(operation);          \
+  qsProfileScope.claim()
+#define QS_PROFILE_BYTES(bytes) qsProfileScope.setBytes(bytes)
+#else
+#define QS_PROFILE(operation)
+#define QS_PROFILE_RAW(operation)
+#define QS_PROFILE_BYTES(bytes)
+#endif
+
+/* Call the QSerializer::Tracer hooks around one property; the size
+ * expression is only evaluated when the tracer measures bytes. Compiled out
+ * unless QS_ENABLE_TRACING is defined. */
+#ifdef QS_ENABLE_TRACING
+#define QS_TRACE_FIELD(format, direction, property)            \
+  TraceScope qsTraceScope(metaObject()->className(), property, \
+                          Tracer::format, Tracer::direction)
+#define QS_TRACE_BYTES(size) \
+  if (qsTraceScope.measuring()) qsTraceScope.setBytes(size)
+#else
+#define QS_TRACE_FIELD(format, direction, property)
+#define QS_TRACE_BYTES(size)
+#endif
+
 class QSerializer {
   Q_GADGET
   QS_BASE_SERIALIZABLE
  public:
+  /*! \brief  XML form of QS_XML_ARRAY collections of numbers. */
+  enum XmlNumbers {
+    /*! \brief  One <item> element per number. */
+    XmlNumberItems,
+    /*! \brief  The numbers as space-separated text of the array element. */
+    XmlNumberText,
+    /*! \brief  Base64 of the numbers as little-endian binary. */
+    XmlNumberBase64
+  };
+
   struct Options {
     bool skipEmpty = false;
     bool skipNull = false;
     bool skipNullLiterals = false;
+    XmlNumbers xmlNumbers = XmlNumberItems;
+    /*! \brief  Leave the type and index attributes out of XML arrays and
+     * dictionaries; readers do not need them. */
+    bool compactXml = false;
+    /*! \brief  Write fields that hold a single value as attributes of the
+     * class element instead of child elements. */
+    bool xmlAttribute = false;
+  };
+
+  /*! \brief  Groups of options a member can set; the groups it does not
+   * set come from the options of its class. */
+  enum MemberFields {
+    SkipFields = 1,
+    XmlNumberFields = 2,
+    CompactXmlFields = 4,
+    XmlAttributeFields = 8,
+    AllFields = ~0u
   };
 
   struct MemberOptions {
     bool skipEmpty = false;
     bool skipNull = false;
     bool skipNullLiterals = false;
+    XmlNumbers xmlNumbers = XmlNumberItems;
+    bool compactXml = false;
+    bool xmlAttribute = false;
     std::string memberName;
+    unsigned fields = 0;  // MemberFields
   };
 
-  typedef std::map<std::string, Options> OptionsMap;
-  typedef std::map<std::string, std::vector<MemberOptions>> MemberOptionsMap;
+  typedef std::map<std::string, Options, std::less<>> OptionsMap;
+  typedef std::map<std::string, std::vector<MemberOptions>, std::less<>>
+      MemberOptionsMap;
+
+  /*! \brief  Immutable snapshot of all registered class and member options.
+   * Writers publish a modified copy; readers never take the writers' lock.
+   */
+  struct Registry {
+    OptionsMap classOptions;
+    MemberOptionsMap memberOptions;
+  };
 
   virtual ~QSerializer() = default;
 
-  static OptionsMap s_classOptions;
-  static MemberOptionsMap s_memberOptions;
+  /*! \brief  Returns the current options snapshot. Safe to call from any
+   * thread. Each thread keeps the snapshot it last saw, so the usual call is
+   * one atomic load of the version; a newer snapshot is picked up with an
+   * atomic load of the shared pointer. Keep a copy of the pointer to hold a
+   * snapshot past the next call. */
+  static const std::shared_ptr<const Registry>& registry() {
+    static thread_local std::shared_ptr<const Registry> snapshot;
+    static thread_local quint64 version = 0;
+    RegistryStore& store = registryStore();
+    const quint64 latest = store.version.load(std::memory_order_acquire);
+    if (latest != version) {
+      // at least as new as latest; a later one moves the version again
+      snapshot = store.load();
+      version = latest;
+    }
+    return snapshot;
+  }
 
   static void setClassOptions(const std::string& className,
                               const Options& options) {
-    s_classOptions[className] = options;
+    updateRegistry([&](Registry& snapshot) {
+      snapshot.classOptions[className] = options;
+    });
   }
 
-  static Options getClassOptions(const std::string& className) {
-    auto it = s_classOptions.find(className);
-    if (it != s_classOptions.end()) {
+  static Options getClassOptions(const char* className) {
+    const OptionsMap& options = registry()->classOptions;
+    auto it = options.find(className);
+    if (it != options.end()) {
       return it->second;
     }
     return Options();
   }
 
-  static void setMemberOptions(const std::string& className,
-                               const std::string& memberName, bool skipEmpty,
-                               bool skipNull, bool skipNullLiterals) {
-    MemberOptions opts;
-    opts.skipEmpty = skipEmpty;
-    opts.skipNull = skipNull;
-    opts.skipNullLiterals = skipNullLiterals;
-    opts.memberName = memberName;
-    s_memberOptions[className].push_back(opts);
+  static Options getClassOptions(const std::string& className) {
+    return getClassOptions(className.c_str());
+  }
+
+  /*! \brief  Set the skip options of a class, keeping its other options. */
+  static void setClassSkipOptions(const std::string& className,
+                                  const Options& options) {
+    updateRegistry([&](Registry& snapshot) {
+      Options& opts = snapshot.classOptions[className];
+      opts.skipEmpty = options.skipEmpty;
+      opts.skipNull = options.skipNull;
+      opts.skipNullLiterals = options.skipNullLiterals;
+    });
+  }
+
+  static void setClassXmlNumbers(const std::string& className,
+                                 XmlNumbers form) {
+    updateRegistry([&](Registry& snapshot) {
+      snapshot.classOptions[className].xmlNumbers = form;
+    });
+  }
+
+  static void setClassCompactXml(const std::string& className, bool compact) {
+    updateRegistry([&](Registry& snapshot) {
+      snapshot.classOptions[className].compactXml = compact;
+    });
+  }
+
+  static void setClassXmlAttributes(const std::string& className,
+                                    bool attributes) {
+    updateRegistry([&](Registry& snapshot) {
+      snapshot.classOptions[className].xmlAttribute = attributes;
+    });
+  }
+
+  static void setMemberOptions(const std::string& className,
+                               const std::string& memberName, bool skipEmpty,
+                               bool skipNull, bool skipNullLiterals) {
+    updateRegistry([&](Registry& snapshot) {
+      MemberOptions& opts =
+          memberEntry(snapshot.memberOptions[className], memberName);
+      opts.skipEmpty = skipEmpty;
+      opts.skipNull = skipNull;
+      opts.skipNullLiterals = skipNullLiterals;
+      opts.fields |= SkipFields;
+    });
+  }
+
+  static void setMemberXmlNumbers(const std::string& className,
+                                  const std::string& memberName,
+                                  XmlNumbers form) {
+    updateRegistry([&](Registry& snapshot) {
+      MemberOptions& opts =
+          memberEntry(snapshot.memberOptions[className], memberName);
+      opts.xmlNumbers = form;
+      opts.fields |= XmlNumberFields;
+    });
+  }
+
+  static void setMemberCompactXml(const std::string& className,
+                                  const std::string& memberName,
+                                  bool compact) {
+    updateRegistry([&](Registry& snapshot) {
+      MemberOptions& opts =
+          memberEntry(snapshot.memberOptions[className], memberName);
+      opts.compactXml = compact;
+      opts.fields |= CompactXmlFields;
+    });
+  }
+
+  static void setMemberXmlAttribute(const std::string& className,
+                                    const std::string& memberName,
+                                    bool attribute) {
+    updateRegistry([&](Registry& snapshot) {
+      MemberOptions& opts =
+          memberEntry(snapshot.memberOptions[className], memberName);
+      opts.xmlAttribute = attribute;
+      opts.fields |= XmlAttributeFields;
+    });
+  }
+
+  /*! \brief  Resolve all options of one member in a single lookup. The
+   * options of the context in progress win over the registered ones; if
+   * there is no member-level setting, the class-level setting is used. */
+  Options memberOptions(const char* memberName) const {
+    const char* className = metaObject()->className();
+    if (SerializationContext* ctx = SerializationContext::current()) {
+      // the getter toXml() is reading has its options cached already
+      if (ctx->m_memberOwner == this &&
+          std::strcmp(ctx->m_memberName, memberName) == 0) {
+        return *ctx->m_memberOptions;
+      }
+      return ctx->options(className, memberName);
+    }
+    return resolveOptions(*registry(), className, memberName);
+  }
+
+  /*! \brief  Resolve the options of this class like memberOptions() does,
+   * for a member without options of its own. */
+  Options classOptions() const {
+    const char* className = metaObject()->className();
+    if (SerializationContext* ctx = SerializationContext::current()) {
+      return ctx->classOptions(className);
+    }
+    return getClassOptions(className);
+  }
+
+  bool shouldSkipMemberEmpty(const char* memberName) const {
+    return memberOptions(memberName).skipEmpty;
+  }
+
+  bool shouldSkipMemberNull(const char* memberName) const {
+    return memberOptions(memberName).skipNull;
+  }
+
+  bool shouldSkipMemberNullLiterals(const char* memberName) const {
+    return memberOptions(memberName).skipNullLiterals;
+  }
+
+  bool shouldSkipEmpty() const {
+    return classOptions().skipEmpty;
+  }
+
+  bool shouldSkipNull() const {
+    return classOptions().skipNull;
+  }
+
+  bool shouldSkipNullLiterals() const {
+    return classOptions().skipNullLiterals;
+  }
+
+ private:
+  static MemberOptions& memberEntry(std::vector<MemberOptions>& members,
+                                    const std::string& memberName) {
+    auto it = members.begin();
+    while (it != members.end() && it->memberName != memberName) ++it;
+    if (it == members.end()) {
+      it = members.insert(it, MemberOptions());
+      it->memberName = memberName;
+    }
+    return *it;
+  }
+
+  /* Apply the fields the member sets on top of out */
+  static bool findMemberOptions(const Registry& registry, const char* className,
+                                const char* memberName, Options& out) {
+    auto it = registry.memberOptions.find(className);
+    if (it == registry.memberOptions.end()) return false;
+    for (const auto& opt : it->second) {
+      if (opt.memberName == memberName) {
+        if (opt.fields & SkipFields) {
+          out.skipEmpty = opt.skipEmpty;
+          out.skipNull = opt.skipNull;
+          out.skipNullLiterals = opt.skipNullLiterals;
+        }
+        if (opt.fields & XmlNumberFields) out.xmlNumbers = opt.xmlNumbers;
+        if (opt.fields & CompactXmlFields) out.compactXml = opt.compactXml;
+        if (opt.fields & XmlAttributeFields) {
+          out.xmlAttribute = opt.xmlAttribute;
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static bool findClassOptions(const Registry& registry, const char* className,
+                               Options& out) {
+    auto it = registry.classOptions.find(className);
+    if (it == registry.classOptions.end()) return false;
+    out = it->second;
+    return true;
+  }
+
+  static Options resolveOptions(const Registry& registry,
+                                const char* className, const char* memberName) {
+    Options options;
+    findClassOptions(registry, className, options);
+    findMemberOptions(registry, className, memberName, options);
+    return options;
+  }
+
+  /*! \brief  The latest snapshot and its version. A snapshot is freed once
+   * no thread and no context refers to it any more. The mutex serializes
+   * writers only. */
+  struct RegistryStore {
+    std::mutex mutex;
+#ifdef __cpp_lib_atomic_shared_ptr
+    std::atomic<std::shared_ptr<const Registry>> current{
+        std::make_shared<const Registry>()};
+
+    std::shared_ptr<const Registry> load() const { return current.load(); }
+    void publish(std::shared_ptr<const Registry> next) {
+      current.store(std::move(next));
+    }
+#else
+    std::shared_ptr<const Registry> current = std::make_shared<Registry>();
+
+    std::shared_ptr<const Registry> load() const {
+      return std::atomic_load(&current);
+    }
+    void publish(std::shared_ptr<const Registry> next) {
+      std::atomic_store(&current, std::move(next));
+    }
+#endif
+    std::atomic<quint64> version{1};
+  };
+
+  static RegistryStore& registryStore() {
+    static RegistryStore store;
+    return store;
+  }
+
+  /*! \brief  Running averages of the output sizes of toRawJson() and
+   * toRawXml() of a class on this thread. The next call allocates its
+   * buffer for about that much at once instead of growing it step by step;
+   * a single large output moves the average by a quarter of its size. */
+  struct SizeHint {
+    qint64 json = 0;
+    qint64 xml = 0;
+
+    static void update(qint64& hint, qint64 size) {
+      hint = hint > 0 ? hint + (size - hint) / 4 : size;
+    }
+  };
+
+  static SizeHint& sizeHint(const QMetaObject* metaObject) {
+    static thread_local std::unordered_map<const QMetaObject*, SizeHint>
+        hints;
+    return hints[metaObject];
+  }
+
+  /*! \brief  Copy the current snapshot, apply update and publish the copy.
+   * Writers are serialized by a mutex, readers are not blocked. */
+  template <typename Update>
+  static void updateRegistry(Update update) {
+    RegistryStore& store = registryStore();
+    std::lock_guard<std::mutex> lock(store.mutex);
+    std::shared_ptr<Registry> next = std::make_shared<Registry>(*store.load());
+    update(*next);
+    store.publish(std::move(next));
+    store.version.fetch_add(1, std::memory_order_release);
+  }
+
+ public:
+  /*! \brief  Bytes that one member takes in a serialized document; see
+   * jsonSizeReport() / xmlSizeReport(). */
+  struct SizeNode {
+    /*! \brief  Member name; the class name for the root. */
+    std::string name;
+    /*! \brief  Text bytes of the member, `"name":value` in compact JSON or
+     * its element or attribute in XML without indentation, summed over all
+     * occurrences. Brackets, separators, keys and tags around the members
+     * count for the parent only, so a node's bytes are those of its children
+     * plus its own. */
+    qint64 bytes = 0;
+    /*! \brief  Occurrences: one per element for members of objects held in
+     * collections and dictionaries. */
+    qint64 count = 0;
+    /*! \brief  Members of the objects this member holds, merged over all of
+     * them. */
+    std::vector<SizeNode> children;
+
+    SizeNode& child(const char* memberName) {
+      for (SizeNode& node : children) {
+        if (node.name == memberName) return node;
+      }
+      children.emplace_back();
+      children.back().name = memberName;
+      return children.back();
+    }
+
+    /*! \brief  Indented tree, largest members first, with their share of
+     * the parent and their count. */
+    QString toString() const {
+      QString text;
+      appendTo(text, 0, 0);
+      return text;
+    }
+
+   private:
+    void appendTo(QString& text, int depth, qint64 parentBytes) const {
+      text += QString(depth * 2, ' ') + QString::fromStdString(name) + "  " +
+              QString::number(bytes) + " B";
+      if (parentBytes > 0) {
+        text += QString::asprintf("  %.1f%%", 100.0 * bytes / parentBytes);
+      }
+      if (count > 1) text += "  x" + QString::number(count);
+      text += '\n';
+      std::vector<const SizeNode*> sorted;
+      for (const SizeNode& node : children) sorted.push_back(&node);
+      std::stable_sort(sorted.begin(), sorted.end(),
+                       [](const SizeNode* a, const SizeNode* b) {
+                         return a->bytes > b->bytes;
+                       });
+      for (const SizeNode* node : sorted) {
+        node->appendTo(text, depth + 1, bytes);
+      }
+    }
+  };
+
+  /*! \brief  State of one top-level serialization call, shared by all nested
+   * objects. Holds a monotonic arena for the scratch allocations of the parse
+   * path; the arena is released in one shot when the outermost fromJson /
+   * fromXml returns. */
+  class SizeScope;
+
+  class SerializationContext {
+   public:
+#ifdef QS_HAS_PMR
+    SerializationContext() { m_arena.emplace(&m_upstream); }
+
+    /*! \brief  Use a caller-provided buffer as the first arena block, so a
+     * context reused across calls does not touch the heap in steady state.
+     * After a call that needed more, release() moves the arena to a buffer
+     * of the context's own. */
+    SerializationContext(void* buffer, std::size_t size) : m_bufferSize(size) {
+      m_arena.emplace(buffer, size, &m_upstream);
+    }
+
+    std::pmr::memory_resource* resource() { return &*m_arena; }
+#else
+    SerializationContext() = default;
+#endif
+
+    SerializationContext(const SerializationContext&) = delete;
+    SerializationContext& operator=(const SerializationContext&) = delete;
+
+    /*! \brief  Drop every scratch allocation made through this context. The
+     * arena keeps one buffer: when a call needed more than it held, the
+     * next call gets a buffer for all of it (up to kMaxArenaBuffer bytes),
+     * so repeated calls of the same size do not touch the heap. */
+    void release() {
+#ifdef QS_HAS_PMR
+      const std::size_t size = m_bufferSize + m_upstream.taken;
+      if (m_upstream.taken == 0 || size > kMaxArenaBuffer) {
+        m_arena->release();
+        m_upstream.taken = 0;
+        return;
+      }
+      m_arena.reset();
+      m_buffer.reset(new char[size]);
+      m_bufferSize = size;
+      m_upstream.taken = 0;
+      m_arena.emplace(m_buffer.get(), size, &m_upstream);
+#endif
+    }
+
+#ifdef QS_HAS_PMR
+    /*! \brief  Largest arena buffer a context keeps between calls. */
+    static const std::size_t kMaxArenaBuffer = 1 << 20;
+#endif
+
+    /*! \brief  Update mode: collection and dictionary setters deserialize
+     * into the elements already present instead of rebuilding them, so a
+     * long-lived object keeps its nested objects and buffers across calls.
+     * Fields missing from the input keep their previous values. */
+    void setReuseElements(bool reuse) { m_reuseElements = reuse; }
+    bool reuseElements() const { return m_reuseElements; }
+
+    /*! \brief  Options of a class for calls made with this context only.
+     * They take precedence over the registered options, so callers with
+     * different policies for the same class do not touch global state. */
+    void setClassOptions(const std::string& className,
+                         const Options& options) {
+      m_overrides.classOptions[className] = options;
+      m_resolved.clear();
+    }
+
+    /*! \brief  Options of every class and member this context has no
+     * specific options for, overriding the registered ones; e.g. to emit
+     * every field regardless of the skip options. */
+    void setDefaultOptions(const Options& options) {
+      m_defaultOptions = options;
+      m_hasDefaultOptions = true;
+      m_resolved.clear();
+    }
+
+    /*! \brief  Options of one member for calls made with this context. */
+    void setMemberOptions(const std::string& className,
+                          const std::string& memberName,
+                          const Options& options) {
+      MemberOptions& opts =
+          memberEntry(m_overrides.memberOptions[className], memberName);
+      opts.skipEmpty = options.skipEmpty;
+      opts.skipNull = options.skipNull;
+      opts.skipNullLiterals = options.skipNullLiterals;
+      opts.xmlNumbers = options.xmlNumbers;
+      opts.compactXml = options.compactXml;
+      opts.xmlAttribute = options.xmlAttribute;
+      opts.fields = AllFields;
+      m_resolved.clear();
+    }
+
+    /*! \brief  Resolve the options of one member: context member, context
+     * class, context default, registered member, registered class, in that
+     * order. */
+    Options options(const char* className, const char* memberName) const {
+      Options options;
+      if (findMemberOptions(m_overrides, className, memberName, options) ||
+          findClassOptions(m_overrides, className, options)) {
+        return options;
+      }
+      if (m_hasDefaultOptions) return m_defaultOptions;
+      return resolveOptions(*registry(), className, memberName);
+    }
+
+    /*! \brief  Resolve the options of a class: context class, context
+     * default, registered class, in that order. */
+    Options classOptions(const char* className) const {
+      Options options;
+      if (findClassOptions(m_overrides, className, options)) return options;
+      if (m_hasDefaultOptions) return m_defaultOptions;
+      return getClassOptions(className);
+    }
+
+    /*! \brief  Options of every property of metaObject, indexed like its
+     * properties. Resolved once per class and context, so serializing many
+     * objects of the same class does not search the registry again. A new
+     * registry snapshot is picked up by the next outermost call only, since
+     * nested calls still hold references into the cache. */
+    const std::vector<Options>& propertyOptions(
+        const QMetaObject* metaObject) {
+      const std::shared_ptr<const Registry>& snapshot = registry();
+      if (snapshot != m_resolvedFrom && m_depth <= 1) {
+        m_resolved.clear();
+        m_resolvedFrom = snapshot;
+      }
+      std::vector<Options>& options = m_resolved[metaObject];
+      if (options.empty()) {
+        int count = metaObject->propertyCount();
+        options.reserve(count);
+        for (int i = 0; i < count; i++) {
+          options.push_back(this->options(metaObject->className(),
+                                          metaObject->property(i).name()));
+        }
+      }
+      return options;
+    }
+
+    /*! \brief  Maximum nesting depth of objects, 0 for no limit. Deeper
+     * objects are left out (toJson / toXml) or untouched (fromJson /
+     * fromXml) and limitExceeded() is set. */
+    void setMaxDepth(int depth) { m_maxDepth = depth; }
+    int maxDepth() const { return m_maxDepth; }
+
+    /*! \brief  Maximum number of elements read into one collection, 0 for
+     * no limit. Longer input is truncated and limitExceeded() is set. */
+    void setMaxCollectionSize(qint64 size) { m_maxCollectionSize = size; }
+    qint64 maxCollectionSize() const { return m_maxCollectionSize; }
+
+    /*! \brief  True once a limit has been hit; stays set until cleared. */
+    bool limitExceeded() const { return m_limitExceeded; }
+    void clearLimitExceeded() { m_limitExceeded = false; }
+
+    /*! \brief  Context of the call in progress on this thread, or nullptr. */
+    static SerializationContext* current() { return currentSlot(); }
+
+   private:
+    friend class QSerializer;
+
+    static SerializationContext*& currentSlot() {
+      static thread_local SerializationContext* ctx = nullptr;
+      return ctx;
+    }
+
+    /* Used by calls made without a context; kept per thread so its options
+     * cache survives between calls. */
+    static SerializationContext& threadContext() {
+      static thread_local SerializationContext ctx;
+      return ctx;
+    }
+
+#ifdef QS_HAS_PMR
+    /* Heap behind the arena; counts what the arena takes from it */
+    class Upstream : public std::pmr::memory_resource {
+     public:
+      std::size_t taken = 0;
+
+     private:
+      void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        taken += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+      }
+
+      void do_deallocate(void* p, std::size_t bytes,
+                         std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+      }
+
+      bool do_is_equal(
+          const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+      }
+    };
+
+    // destroyed in reverse: the arena returns its blocks first
+    Upstream m_upstream;
+    std::unique_ptr<char[]> m_buffer;
+    std::size_t m_bufferSize = 0;
+    std::optional<std::pmr::monotonic_buffer_resource> m_arena;
+#endif
+    bool m_reuseElements = false;
+    Registry m_overrides;
+    Options m_defaultOptions;
+    bool m_hasDefaultOptions = false;
+    std::unordered_map<const QMetaObject*, std::vector<Options>> m_resolved;
+    std::shared_ptr<const Registry> m_resolvedFrom;
+    int m_maxDepth = 0;
+    qint64 m_maxCollectionSize = 0;
+    int m_depth = 0;
+    bool m_limitExceeded = false;
+    // member being measured while a size report is made; see SizeScope
+    SizeScope* m_sizeScope = nullptr;
+    // property whose getter toXml() is reading; see MemberScope
+    const QSerializer* m_memberOwner = nullptr;
+    const char* m_memberName = nullptr;
+    const Options* m_memberOptions = nullptr;
+#ifdef QS_HAS_XML
+    QDomDocument* m_memberDocument = nullptr;
+#endif
+  };
+
+  /*! \brief  Makes a context current for the lifetime of the scope. Nested
+   * calls join the context of the outermost call; the outermost call uses a
+   * per-thread context when the caller did not pass its own. A scope opened
+   * without an explicit context is one level of object nesting. */
+  class ContextScope {
+   public:
+    explicit ContextScope(SerializationContext* ctx = nullptr)
+        : m_previous(SerializationContext::currentSlot()), m_nested(!ctx) {
+      if (ctx) {
+        m_release = ctx != m_previous;
+        SerializationContext::currentSlot() = ctx;
+      } else if (!m_previous) {
+        m_release = true;
+        SerializationContext::currentSlot() =
+            &SerializationContext::threadContext();
+      }
+      if (m_nested) ++context()->m_depth;
+    }
+
+    ~ContextScope() {
+      if (m_nested) --context()->m_depth;
+      if (m_release) {
+        SerializationContext::currentSlot()->release();
+      }
+      SerializationContext::currentSlot() = m_previous;
+    }
+
+    ContextScope(const ContextScope&) = delete;
+    ContextScope& operator=(const ContextScope&) = delete;
+
+    SerializationContext* context() const {
+      return SerializationContext::currentSlot();
+    }
+
+    /*! \brief  True (and the limit flagged) when this scope is nested
+     * deeper than the context allows. */
+    bool depthExceeded() const {
+      SerializationContext* ctx = context();
+      if (ctx->m_maxDepth <= 0 || ctx->m_depth <= ctx->m_maxDepth) {
+        return false;
+      }
+      ctx->m_limitExceeded = true;
+      return true;
+    }
+
+   private:
+    SerializationContext* m_previous;
+    bool m_nested;
+    bool m_release = false;
+  };
+
+#ifdef QS_ENABLE_PROFILING
+  /*! \brief  Per-class counters of toJson / fromJson / toXml / fromXml
+   * calls: count, total and maximum latency, a log2 latency histogram,
+   * bytes of the raw variants and heap allocations. Nested objects count
+   * for their own class, and their time is part of the parent's too. Each
+   * thread updates its own table, so threads never wait on each other. */
+  class Profiler {
+   public:
+    enum Operation { ToJson, FromJson, ToXml, FromXml, OperationCount };
+
+    /*! \brief  Bucket i counts calls of less than 2^(i+1) ns; the last one
+     * takes everything slower. */
+    static const int kHistogramBuckets = 32;
+
+    struct Counters {
+      quint64 calls = 0;
+      quint64 totalNs = 0;
+      quint64 maxNs = 0;
+      quint64 bytes = 0;
+      quint64 allocations = 0;
+      std::array<quint64, kHistogramBuckets> histogram{};
+
+      void merge(const Counters& other) {
+        calls += other.calls;
+        totalNs += other.totalNs;
+        maxNs = qMax(maxNs, other.maxNs);
+        bytes += other.bytes;
+        allocations += other.allocations;
+        for (int i = 0; i < kHistogramBuckets; i++) {
+          histogram[i] += other.histogram[i];
+        }
+      }
+    };
+
+    typedef quint64 (*AllocationCounter)();
+
+    /*! \brief  Source of the process-wide allocation count, e.g. a counting
+     * malloc hook; the library cannot observe the allocator itself. Without
+     * one, allocations stay 0. */
+    static void setAllocationCounter(AllocationCounter counter) {
+      allocationCounter().store(counter, std::memory_order_relaxed);
+    }
+
+    static quint64 allocations() {
+      AllocationCounter counter =
+          allocationCounter().load(std::memory_order_relaxed);
+      return counter ? counter() : 0;
+    }
+
+    static const char* operationName(Operation operation) {
+      static const char* const names[] = {"toJson", "fromJson", "toXml",
+                                          "fromXml"};
+      return names[operation];
+    }
+
+    static void record(const char* className, Operation operation,
+                       quint64 ns, quint64 bytes, quint64 allocations) {
+      ThreadTable& table = threadTable();
+      std::lock_guard<std::mutex> lock(table.mutex);
+      Counters& counters = table.classes[className][operation];
+      counters.calls++;
+      counters.totalNs += ns;
+      counters.maxNs = qMax(counters.maxNs, ns);
+      counters.bytes += bytes;
+      counters.allocations += allocations;
+      int bucket = 0;
+      while (bucket < kHistogramBuckets - 1 && (ns >> (bucket + 1))) {
+        ++bucket;
+      }
+      counters.histogram[bucket]++;
+    }
+
+    /*! \brief  Counters of all threads, merged by class name. */
+    static std::map<std::string, std::array<Counters, OperationCount>>
+    snapshot() {
+      std::map<std::string, std::array<Counters, OperationCount>> result;
+      Store& store = storage();
+      std::lock_guard<std::mutex> storeLock(store.mutex);
+      for (const std::shared_ptr<ThreadTable>& table : store.tables) {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        for (const auto& entry : table->classes) {
+          std::array<Counters, OperationCount>& counters = result[entry.first];
+          for (int op = 0; op < OperationCount; op++) {
+            counters[op].merge(entry.second[op]);
+          }
+        }
+      }
+      return result;
+    }
+
+    /*! \brief  snapshot() as a JSON array with one entry per class and
+     * operation that was called; the histogram lists the non-empty buckets
+     * by their upper bound in ns. */
+    static QByteArray dump() {
+      QByteArray json = "[";
+      bool first = true;
+      for (const auto& entry : snapshot()) {
+        for (int op = 0; op < OperationCount; op++) {
+          const Counters& c = entry.second[op];
+          if (!c.calls) continue;
+          if (!first) json += ',';
+          first = false;
+          json += "{\"class\":\"" + QByteArray(entry.first.c_str()) +
+                  "\",\"operation\":\"" + operationName(Operation(op)) +
+                  "\",\"calls\":" + QByteArray::number(c.calls) +
+                  ",\"total_ns\":" + QByteArray::number(c.totalNs) +
+                  ",\"max_ns\":" + QByteArray::number(c.maxNs) +
+                  ",\"bytes\":" + QByteArray::number(c.bytes) +
+                  ",\"allocations\":" + QByteArray::number(c.allocations) +
+                  ",\"histogram\":[";
+          bool firstBucket = true;
+          for (int i = 0; i < kHistogramBuckets; i++) {
+            if (!c.histogram[i]) continue;
+            if (!firstBucket) json += ',';
+            firstBucket = false;
+            json += "{\"below_ns\":" +
+                    (i == kHistogramBuckets - 1
+                         ? QByteArray("null")
+                         : QByteArray::number(quint64(1) << (i + 1))) +
+                    ",\"count\":" + QByteArray::number(c.histogram[i]) + '}';
+          }
+          json += "]}";
+        }
+      }
+      json += ']';
+      return json;
+    }
+
+    /*! \brief  Zero the counters of all threads. */
+    static void reset() {
+      Store& store = storage();
+      std::lock_guard<std::mutex> storeLock(store.mutex);
+      for (const std::shared_ptr<ThreadTable>& table : store.tables) {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        table->classes.clear();
+      }
+    }
+
+   private:
+    /* Keyed by the className() pointer; names are merged in snapshot() */
+    struct ThreadTable {
+      std::mutex mutex;
+      std::unordered_map<const char*, std::array<Counters, OperationCount>>
+          classes;
+    };
+
+    /* Owns every table, so counters outlive the threads that made them */
+    struct Store {
+      std::mutex mutex;
+      std::vector<std::shared_ptr<ThreadTable>> tables;
+    };
+
+    static Store& storage() {
+      static Store store;
+      return store;
+    }
+
+    static ThreadTable& threadTable() {
+      static thread_local std::shared_ptr<ThreadTable> table = [] {
+        std::shared_ptr<ThreadTable> created = std::make_shared<ThreadTable>();
+        Store& store = storage();
+        std::lock_guard<std::mutex> lock(store.mutex);
+        store.tables.push_back(created);
+        return created;
+      }();
+      return *table;
+    }
+
+    static std::atomic<AllocationCounter>& allocationCounter() {
+      static std::atomic<AllocationCounter> counter{nullptr};
+      return counter;
+    }
+  };
+
+  /*! \brief  Times one call of obj for the Profiler. A raw variant claims
+   * the call it delegates to on the same object, so a toRawJson is
+   * recorded once, with its bytes. */
+  class ProfileScope {
+   public:
+    ProfileScope(const QSerializer* obj, Profiler::Operation operation)
+        : m_obj(obj), m_operation(operation) {
+      if (claimed() == obj) {
+        claimed() = nullptr;
+        m_active = false;
+        return;
+      }
+      m_allocations = Profiler::allocations();
+      m_start = std::chrono::steady_clock::now();
+    }
+
+    ~ProfileScope() {
+      if (claimed() == m_obj) claimed() = nullptr;
+      if (!m_active) return;
+      quint64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - m_start)
+                       .count();
+      Profiler::record(m_obj->metaObject()->className(), m_operation, ns,
+                       m_bytes, Profiler::allocations() - m_allocations);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    /*! \brief  Let the next scope on the same object join this one. */
+    void claim() { claimed() = m_obj; }
+    void setBytes(qint64 bytes) { m_bytes = quint64(bytes); }
+
+   private:
+    static const QSerializer*& claimed() {
+      static thread_local const QSerializer* obj = nullptr;
+      return obj;
+    }
+
+    const QSerializer* m_obj;
+    Profiler::Operation m_operation;
+    bool m_active = true;
+    quint64 m_bytes = 0;
+    quint64 m_allocations = 0;
+    std::chrono::steady_clock::time_point m_start;
+  };
+#endif
+
+#ifdef QS_ENABLE_TRACING
+  /*! \brief  Hooks called when a property of any object starts and
+   * finishes serializing or deserializing, on every thread. Meant to attach
+   * a sampling profiler or to record a trace of one request (see
+   * ChromeTrace). */
+  class Tracer {
+   public:
+    enum Format { Json, Xml };
+    enum Direction { Serialize, Deserialize };
+
+    struct Event {
+      const char* className;
+      const char* propertyName;
+      Format format;
+      Direction direction;
+      /*! \brief  Size of the property's JSON / XML text; set for the end
+       * event when measureBytes(), -1 otherwise. */
+      qint64 bytes;
+    };
+
+    typedef void (*Hook)(const Event& event, void* userData);
+
+    /*! \brief  Install the hooks, or remove them with nullptr. Change them
+     * only while no serialization is in progress. */
+    static void setHooks(Hook begin, Hook end, void* userData = nullptr) {
+      state().userData.store(userData, std::memory_order_relaxed);
+      state().end.store(end, std::memory_order_relaxed);
+      state().begin.store(begin, std::memory_order_release);
+    }
+
+    static void* userData() {
+      return state().userData.load(std::memory_order_relaxed);
+    }
+
+    /*! \brief  Measure the text size of every traced property. Costs an
+     * extra serialization of each value. */
+    static void setMeasureBytes(bool measure) {
+      state().measureBytes.store(measure, std::memory_order_relaxed);
+    }
+    static bool measureBytes() {
+      return state().measureBytes.load(std::memory_order_relaxed);
+    }
+
+   private:
+    friend class QSerializer;
+
+    struct State {
+      std::atomic<Hook> begin{nullptr};
+      std::atomic<Hook> end{nullptr};
+      std::atomic<void*> userData{nullptr};
+      std::atomic<bool> measureBytes{false};
+    };
+
+    static State& state() {
+      static State state;
+      return state;
+    }
+  };
+
+  /*! \brief  Reports one property to the Tracer hooks for its lifetime. */
+  class TraceScope {
+   public:
+    TraceScope(const char* className, const char* propertyName,
+               Tracer::Format format, Tracer::Direction direction)
+        : m_event{className, propertyName, format, direction, -1} {
+      Tracer::Hook begin =
+          Tracer::state().begin.load(std::memory_order_acquire);
+      if (!begin) return;
+      m_end = Tracer::state().end.load(std::memory_order_relaxed);
+      begin(m_event, Tracer::userData());
+    }
+
+    ~TraceScope() {
+      if (m_end) m_end(m_event, Tracer::userData());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    bool measuring() const { return m_end && Tracer::measureBytes(); }
+    void setBytes(qint64 bytes) { m_event.bytes = bytes; }
+
+   private:
+    Tracer::Event m_event;
+    Tracer::Hook m_end = nullptr;
+  };
+
+  /*! \brief  Records the Tracer events as Chrome trace-event JSON, to be
+   * loaded in chrome://tracing or Perfetto. Install it around the request
+   * of interest; events of all threads are kept. */
+  class ChromeTrace {
+   public:
+    ChromeTrace() : m_start(std::chrono::steady_clock::now()) {}
+    ~ChromeTrace() { uninstall(); }
+
+    ChromeTrace(const ChromeTrace&) = delete;
+    ChromeTrace& operator=(const ChromeTrace&) = delete;
+
+    void install() {
+      Tracer::setHooks(&ChromeTrace::begin, &ChromeTrace::end, this);
+    }
+
+    void uninstall() {
+      if (Tracer::userData() == this) Tracer::setHooks(nullptr, nullptr);
+    }
+
+    void clear() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_records.clear();
+    }
+
+    /*! \brief  {"traceEvents": [...]} with one B/E pair per property;
+     * the end event carries the byte count when it was measured. */
+    QByteArray toJson() const {
+      static const char* const formats[] = {"json", "xml"};
+      static const char* const directions[] = {"serialize", "deserialize"};
+      std::lock_guard<std::mutex> lock(m_mutex);
+      QByteArray json = "{\"traceEvents\":[";
+      for (std::size_t i = 0; i < m_records.size(); i++) {
+        const Record& r = m_records[i];
+        if (i) json += ',';
+        json += "{\"name\":\"" + QByteArray(r.event.className) + '.' +
+                r.event.propertyName + "\",\"cat\":\"" +
+                formats[r.event.format] + ',' +
+                directions[r.event.direction] + "\",\"ph\":\"" +
+                (r.begin ? 'B' : 'E') + "\",\"ts\":" +
+                QByteArray::number(r.us, 'f', 3) +
+                ",\"pid\":1,\"tid\":" + QByteArray::number(r.thread);
+        if (!r.begin && r.event.bytes >= 0) {
+          json += ",\"args\":{\"bytes\":" +
+                  QByteArray::number(r.event.bytes) + '}';
+        }
+        json += '}';
+      }
+      json += "]}";
+      return json;
+    }
+
+   private:
+    struct Record {
+      Tracer::Event event;
+      bool begin;
+      double us;
+      int thread;
+    };
+
+    static void begin(const Tracer::Event& event, void* self) {
+      static_cast<ChromeTrace*>(self)->add(event, true);
+    }
+
+    static void end(const Tracer::Event& event, void* self) {
+      static_cast<ChromeTrace*>(self)->add(event, false);
+    }
+
+    static int threadId() {
+      static std::atomic<int> next{1};
+      static thread_local int id = next++;
+      return id;
+    }
+
+    void add(const Tracer::Event& event, bool begin) {
+      double us = std::chrono::duration<double, std::micro>(
+                      std::chrono::steady_clock::now() - m_start)
+                      .count();
+      Record record{event, begin, us, threadId()};
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_records.push_back(record);
+    }
+
+    std::chrono::steady_clock::time_point m_start;
+    mutable std::mutex m_mutex;
+    std::vector<Record> m_records;
+  };
+#endif
+
+  /*! \brief  While a size report is made, the node of one member: the
+   * members of nested objects serialized in this scope attach to it, and
+   * the objects report their own size here when they are done. Sizes are
+   * so computed bottom-up, each byte measured once, and a member that ends
+   * up skipped leaves no node behind. */
+  class SizeScope {
+   public:
+    SizeScope(SerializationContext* ctx, const char* memberName)
+        : m_ctx(ctx), m_outer(ctx->m_sizeScope) {
+      if (!m_outer) return;
+      std::vector<SizeNode>& siblings = m_outer->m_node->children;
+      m_created = std::none_of(siblings.begin(), siblings.end(),
+                               [memberName](const SizeNode& node) {
+                                 return node.name == memberName;
+                               });
+      m_node = &m_outer->m_node->child(memberName);
+      ctx->m_sizeScope = this;
+    }
+
+    /*! \brief  The scope of a whole report, whose root object reports its
+     * size here. */
+    SizeScope(SerializationContext* ctx, SizeNode& root)
+        : m_ctx(ctx), m_outer(ctx->m_sizeScope), m_node(&root) {
+      ctx->m_sizeScope = this;
+    }
+
+    ~SizeScope() {
+      if (!m_node) return;
+      m_ctx->m_sizeScope = m_outer;
+      if (m_created && m_node->count == 0) m_outer->m_node->children.pop_back();
+    }
+
+    SizeScope(const SizeScope&) = delete;
+    SizeScope& operator=(const SizeScope&) = delete;
+
+    bool active() const { return m_node; }
+
+    /*! \brief  Count one occurrence of the member. */
+    void add(qint64 bytes) {
+      m_node->bytes += bytes;
+      m_node->count++;
+    }
+
+    /*! \brief  Total size of the objects serialized in this scope. */
+    qint64 nestedBytes() const { return m_nestedBytes; }
+
+#ifdef QS_HAS_JSON
+    /*! \brief  Report the compact size of an object serialized in this
+     * scope. */
+    void addObject(qint64 bytes, const QJsonObject& object) {
+      m_nestedBytes += bytes;
+      m_nestedCount++;
+      m_lastObject = object;
+    }
+
+    /*! \brief  Compact size of value, the member value of this scope. The
+     * objects serialized in the scope count with their reported sizes, so
+     * only the brackets, separators and keys around them are measured. */
+    qint64 jsonSize(const QJsonValue& value) const {
+      if (m_nestedCount > 0 && value.isArray() &&
+          value.toArray().size() == m_nestedCount) {
+        return m_nestedBytes + 2 + (m_nestedCount - 1);
+      }
+      if (m_nestedCount > 0 && value.isObject()) {
+        QJsonObject object = value.toObject();
+        // a nested object itself, or a dictionary of them
+        if (m_nestedCount == 1 && object == m_lastObject) return m_nestedBytes;
+        if (object.size() == m_nestedCount) {
+          qint64 bytes = m_nestedBytes + 2 + (m_nestedCount - 1);
+          for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            bytes += QSerializer::jsonSize(QJsonValue(it.key())) + 1;
+          }
+          return bytes;
+        }
+      }
+      return QSerializer::jsonSize(value);
+    }
+#endif
+
+#ifdef QS_HAS_XML
+    /*! \brief  Report the size of an object serialized in this scope and
+     * the node it returned. */
+    void addObject(qint64 bytes, const QDomNode& node) {
+      m_nestedBytes += bytes;
+      m_nestedNodes.push_back(node);
+    }
+
+    /*! \brief  Size of node, the member value of this scope. The objects
+     * serialized in the scope count with their reported sizes: they are
+     * swapped for empty placeholder elements while the rest is measured. */
+    qint64 xmlSize(const QDomNode& node) const {
+      if (m_nestedNodes.empty()) return QSerializer::xmlSize(node);
+      if (m_nestedNodes.size() == 1 && node == m_nestedNodes.front()) {
+        return m_nestedBytes;
+      }
+      for (const QDomNode& nested : m_nestedNodes) {
+        if (nested.parentNode().isNull()) return QSerializer::xmlSize(node);
+      }
+      QDomDocument scratch;
+      std::vector<QDomElement> placeholders;
+      placeholders.reserve(m_nestedNodes.size());
+      for (const QDomNode& nested : m_nestedNodes) {
+        placeholders.push_back(scratch.createElement("_"));
+        nested.parentNode().replaceChild(placeholders.back(), nested);
+      }
+      // <_/>
+      qint64 bytes = QSerializer::xmlSize(node) -
+                     4 * qint64(placeholders.size()) + m_nestedBytes;
+      for (std::size_t i = 0; i < placeholders.size(); i++) {
+        placeholders[i].parentNode().replaceChild(m_nestedNodes[i],
+                                                  placeholders[i]);
+      }
+      return bytes;
+    }
+#endif
+
+   private:
+    SerializationContext* m_ctx;
+    SizeScope* m_outer;
+    SizeNode* m_node = nullptr;
+    bool m_created = false;
+    qint64 m_nestedBytes = 0;
+#ifdef QS_HAS_JSON
+    int m_nestedCount = 0;
+    QJsonObject m_lastObject;
+#endif
+#ifdef QS_HAS_XML
+    std::vector<QDomNode> m_nestedNodes;
+#endif
+  };
+
+#ifdef QS_HAS_XML
+  /*! \brief  While toXml() reads one property, points memberOptions() of
+   * that property at its entry in propertyOptions(), so the getter does not
+   * resolve the options again, and xmlAttribute() at the document being
+   * built. */
+  class MemberScope {
+   public:
+    MemberScope(SerializationContext* ctx, const QSerializer* owner,
+                const char* memberName, const Options* options,
+                QDomDocument* document)
+        : m_ctx(ctx),
+          m_owner(ctx->m_memberOwner),
+          m_name(ctx->m_memberName),
+          m_options(ctx->m_memberOptions),
+          m_document(ctx->m_memberDocument) {
+      ctx->m_memberOwner = owner;
+      ctx->m_memberName = memberName;
+      ctx->m_memberOptions = options;
+      ctx->m_memberDocument = document;
+    }
+
+    ~MemberScope() {
+      m_ctx->m_memberOwner = m_owner;
+      m_ctx->m_memberName = m_name;
+      m_ctx->m_memberOptions = m_options;
+      m_ctx->m_memberDocument = m_document;
+    }
+
+    MemberScope(const MemberScope&) = delete;
+    MemberScope& operator=(const MemberScope&) = delete;
+
+   private:
+    SerializationContext* m_ctx;
+    const QSerializer* m_owner;
+    const char* m_name;
+    const Options* m_options;
+    QDomDocument* m_document;
+  };
+#endif
+
+  /* Vector whose storage comes from the arena of the current context */
+#ifdef QS_HAS_PMR
+  template <typename T>
+  using ScratchVector = std::pmr::vector<T>;
+#else
+  template <typename T>
+  using ScratchVector = std::vector<T>;
+#endif
+
+  template <typename T>
+  static ScratchVector<T> makeScratchVector() {
+#ifdef QS_HAS_PMR
+    SerializationContext* ctx = SerializationContext::current();
+    return ScratchVector<T>(ctx ? ctx->resource()
+                                : std::pmr::new_delete_resource());
+#else
+    return ScratchVector<T>();
+#endif
+  }
+
+  /*! \brief  True when the call in progress runs in update mode. */
+  static bool reuseElements() {
+    SerializationContext* ctx = SerializationContext::current();
+    return ctx && ctx->reuseElements();
+  }
+
+  /*! \brief  Number of the n incoming elements a collection may take under
+   * the limits of the call in progress. */
+  template <typename Size>
+  static Size limitCollection(Size n) {
+    SerializationContext* ctx = SerializationContext::current();
+    if (!ctx || ctx->m_maxCollectionSize <= 0 ||
+        static_cast<qint64>(n) <= ctx->m_maxCollectionSize) {
+      return n;
+    }
+    ctx->m_limitExceeded = true;
+    return static_cast<Size>(ctx->m_maxCollectionSize);
+  }
+
+  /*! \brief  Prepare a collection for n incoming elements. In update mode the
+   * first min(size, n) elements are kept for in-place deserialization and
+   * the rest is dropped without releasing capacity; otherwise the collection
+   * is cleared. Returns the number of kept elements. */
+  template <typename Container>
+  static int prepareCollection(Container& container, qint64 n) {
+    if (!reuseElements()) {
+      container.clear();
+      return 0;
+    }
+    int kept = static_cast<int>(qMin<qint64>(container.size(), n));
+    container.erase(container.begin() + kept, container.end());
+    return kept;
+  }
+
+  /*! \brief  Reserve room for n elements in containers that provide
+   * reserve() (QVector, QList, QHash, std::vector, std::unordered_map, ...);
+   * a no-op for the others. */
+  template <typename Container>
+  static void reserve(Container& container, std::size_t n) {
+    reserve(container, n, 0);
+  }
+
+ private:
+  template <typename Container>
+  static auto reserve(Container& container, std::size_t n, int)
+      -> decltype(container.reserve(typename Container::size_type()), void()) {
+    container.reserve(static_cast<typename Container::size_type>(n));
+  }
+
+  template <typename Container>
+  static void reserve(Container&, std::size_t, long) {}
+
+  /* Key of a Qt (key()) or STL (->first) dictionary iterator */
+  template <typename Iterator>
+  static auto dictKey(const Iterator& it, int) -> decltype(it.key()) {
+    return it.key();
+  }
+
+  template <typename Iterator>
+  static auto dictKey(const Iterator& it, long) -> decltype((it->first)) {
+    return it->first;
+  }
+
+  /* Index of the lowest set bit of a non-zero mask */
+  static unsigned trailingZeros(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return unsigned(index);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+  }
+
+ public:
+  /*! \brief  Bytes formatInteger() and formatDouble() may write. */
+  static const int kNumberBufferSize = 32;
+
+  /*! \brief  Write the decimal digits of an integer to out and return the
+   * end. Two digits are taken per division from a table of digit pairs. */
+  template <typename T>
+  static char* formatInteger(char* out, T value) {
+    typedef typename std::make_unsigned<T>::type Unsigned;
+    Unsigned n = static_cast<Unsigned>(value);
+    if (isNegative(value)) {
+      *out++ = '-';
+      n = Unsigned(0) - n;
+    }
+    static const char kPairs[] =
+        "000102030405060708091011121314151617181920212223242526272829"
+        "303132333435363738394041424344454647484950515253545556575859"
+        "606162636465666768697071727374757677787980818283848586878889"
+        "90919293949596979899";
+    char digits[24];
+    char* p = digits + sizeof(digits);
+    while (n >= 100) {
+      const char* pair = kPairs + 2 * (n % 100);
+      n /= 100;
+      *--p = pair[1];
+      *--p = pair[0];
+    }
+    if (n >= 10) {
+      const char* pair = kPairs + 2 * n;
+      *--p = pair[1];
+      *--p = pair[0];
+    } else {
+      *--p = char('0' + n);
+    }
+    std::size_t size = digits + sizeof(digits) - p;
+    std::memcpy(out, p, size);
+    return out + size;
+  }
+
+  /*! \brief  Write the shortest text that reads back as the same double to
+   * out and return the end, laid out like QString::number(value, 'g',
+   * QLocale::FloatingPointShortest) as QVariant and QJsonDocument use it:
+   * plain digits unless the exponent form is shorter, "nan", "inf". */
+  static char* formatDouble(char* out, double value) {
+#ifdef QS_HAS_FLOAT_CHARCONV
+    return formatFloating(out, value);
+#else
+    QByteArray text =
+        QByteArray::number(value, 'g', QLocale::FloatingPointShortest);
+    return copyText(out, text.constData(), text.size());
+#endif
+  }
+
+  /*! \brief  Text of a member value in XML and of JSON object keys. Numbers
+   * are formatted directly, other types go through QVariant. */
+  template <typename T>
+  static QString toText(const T& value) {
+    return QVariant(value).toString();
+  }
+
+  static QString toText(const QString& value) { return value; }
+  static QString toText(int value) { return integerText(value); }
+  static QString toText(uint value) { return integerText(value); }
+  static QString toText(qint64 value) { return integerText(value); }
+  static QString toText(quint64 value) { return integerText(value); }
+
+  static QString toText(double value) {
+    char text[kNumberBufferSize];
+    return QString::fromLatin1(text, int(formatDouble(text, value) - text));
+  }
+
+#ifdef QS_HAS_FLOAT_CHARCONV
+  static QString toText(float value) {
+    char text[kNumberBufferSize];
+    return QString::fromLatin1(text, int(formatFloating(text, value) - text));
+  }
+#endif
+
+  /*! \brief  Convert the text of an XML element or attribute, or a JSON
+   * object key, to a member of type T. Numbers are parsed in place with
+   * from_chars, other types go through QVariant. As with QVariant, text
+   * that is not a number of type T, or is out of its range, gives 0. */
+  template <typename T>
+  static T fromText(const QString& text) {
+    return fromText(text, static_cast<T*>(nullptr));
+  }
+
+  /*! \brief  The numbers of a collection as little-endian binary, for
+   * binary formats and the base64 XML form. */
+  template <typename Container>
+  static QByteArray packLittleEndian(const Container& numbers) {
+    typedef typename Container::value_type T;
+    static_assert(std::is_arithmetic<T>::value, "collection of numbers");
+    QByteArray bytes;
+    bytes.resize(int(numbers.size() * sizeof(T)));
+    char* out = bytes.data();
+    for (const T& number : numbers) {
+      std::memcpy(out, &number, sizeof(T));
+      swapToLittleEndian(out, sizeof(T));
+      out += sizeof(T);
+    }
+    return bytes;
+  }
+
+  /*! \brief  Append the numbers of packLittleEndian() output to a
+   * collection, at most limitCollection() of them. A trailing partial
+   * number is ignored. */
+  template <typename Container>
+  static void unpackLittleEndian(const QByteArray& bytes, Container& numbers) {
+    typedef typename Container::value_type T;
+    static_assert(std::is_arithmetic<T>::value, "collection of numbers");
+    std::size_t n = limitCollection(std::size_t(bytes.size()) / sizeof(T));
+    reserve(numbers, std::size_t(numbers.size()) + n);
+    const char* in = bytes.constData();
+    for (std::size_t i = 0; i < n; i++, in += sizeof(T)) {
+      char raw[sizeof(T)];
+      std::memcpy(raw, in, sizeof(T));
+      swapToLittleEndian(raw, sizeof(T));
+      T number;
+      std::memcpy(&number, raw, sizeof(T));
+      numbers.append(number);
+    }
+  }
+
+ private:
+  template <typename T>
+  static bool isNegative(T value) {
+    return std::is_signed<T>::value && value < T(0);
+  }
+
+  static char* copyText(char* out, const char* text, std::size_t size) {
+    std::memcpy(out, text, size);
+    return out + size;
+  }
+
+#ifdef QS_HAS_FLOAT_CHARCONV
+  /* Shortest digits from to_chars, laid out by the rule of QLocale */
+  template <typename T>
+  static char* formatFloating(char* out, T value) {
+    if (std::isnan(value)) return copyText(out, "nan", 3);
+    if (std::isinf(value)) {
+      return value < 0 ? copyText(out, "-inf", 4) : copyText(out, "inf", 3);
+    }
+    char sci[kNumberBufferSize];
+    const char* end =
+        std::to_chars(sci, sci + sizeof(sci), value,
+                      std::chars_format::scientific)
+            .ptr;
+    const char* p = sci;
+    if (*p == '-') *out++ = *p++;
+    char digits[kNumberBufferSize];
+    int count = 0;
+    for (; *p != 'e'; ++p) {
+      if (*p != '.') digits[count++] = *p;
+    }
+    int exponent = 0;
+    std::from_chars(p + (p[1] == '+' ? 2 : 1), end, exponent);
+    // position of the decimal point relative to the digits
+    int point = exponent + 1;
+    // the exponent form costs at least "e+XX"
+    if (point <= 0 ? 1 - point <= 4 : point <= count + 4) {
+      if (point <= 0) {
+        out = copyText(out, "0.", 2);
+        out = static_cast<char*>(std::memset(out, '0', -point)) - point;
+        return copyText(out, digits, count);
+      }
+      if (point >= count) {
+        out = copyText(out, digits, count);
+        return static_cast<char*>(std::memset(out, '0', point - count)) +
+               (point - count);
+      }
+      out = copyText(out, digits, point);
+      *out++ = '.';
+      return copyText(out, digits + point, count - point);
+    }
+    *out++ = digits[0];
+    if (count > 1) {
+      *out++ = '.';
+      out = copyText(out, digits + 1, count - 1);
+    }
+    *out++ = 'e';
+    *out++ = exponent < 0 ? '-' : '+';
+    if (exponent < 0) exponent = -exponent;
+    if (exponent < 10) *out++ = '0';
+    return formatInteger(out, exponent);
+  }
+#endif
+
+  template <typename T>
+  static QString integerText(T value) {
+    char text[kNumberBufferSize];
+    return QString::fromLatin1(text, int(formatInteger(text, value) - text));
+  }
+
+  template <typename T>
+  static T fromText(const QString& text, T*) {
+    return QVariant(text).value<T>();
+  }
+
+  static QString fromText(const QString& text, QString*) { return text; }
+  static int fromText(const QString& text, int*) {
+    return parseInteger<int>(text);
+  }
+  static uint fromText(const QString& text, uint*) {
+    return parseInteger<uint>(text);
+  }
+  static qint64 fromText(const QString& text, qint64*) {
+    return parseInteger<qint64>(text);
+  }
+  static quint64 fromText(const QString& text, quint64*) {
+    return parseInteger<quint64>(text);
+  }
+  static double fromText(const QString& text, double*) {
+    return parseFloating<double>(text);
+  }
+  static float fromText(const QString& text, float*) {
+    return parseFloating<float>(text);
+  }
+
+  /* Text without surrounding whitespace (which QString::toInt and toDouble
+   * skip too) as ASCII in out, and its length; 0 when it is not ASCII or
+   * longer than kNumberBufferSize */
+  static int numberChars(const QString& text, char* out) {
+    const QChar* begin = text.constData();
+    const QChar* end = begin + text.size();
+    while (begin != end && begin->isSpace()) ++begin;
+    while (end != begin && end[-1].isSpace()) --end;
+    if (end - begin > kNumberBufferSize) return 0;
+    for (const QChar* c = begin; c != end; ++c) {
+      if (c->unicode() >= 0x80) return 0;
+      *out++ = char(c->unicode());
+    }
+    return int(end - begin);
+  }
+
+  /* from_chars takes no leading '+', QString::toInt does */
+  static const char* skipPlus(const char* begin, const char* end) {
+    return end - begin > 1 && *begin == '+' && begin[1] >= '0' &&
+                   begin[1] <= '9'
+               ? begin + 1
+               : begin;
+  }
+
+  /* Overflow gives 0 like QString::toInt; anything from_chars does not
+   * take whole is left to QVariant */
+  template <typename T>
+  static T parseInteger(const QString& text) {
+#ifdef QS_HAS_CHARCONV
+    char chars[kNumberBufferSize];
+    const char* end = chars + numberChars(text, chars);
+    T value;
+    std::from_chars_result result =
+        std::from_chars(skipPlus(chars, end), end, value);
+    if (end != chars && result.ptr == end) {
+      if (result.ec == std::errc()) return value;
+      if (result.ec == std::errc::result_out_of_range) return T();
+    }
+#endif
+    return QVariant(text).value<T>();
+  }
+
+  static void swapToLittleEndian(char* bytes, std::size_t size) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    std::reverse(bytes, bytes + size);
+#else
+    Q_UNUSED(bytes);
+    Q_UNUSED(size);
+#endif
+  }
+
+  template <typename T>
+  static char* formatNumber(char* out, T value, std::false_type) {
+    return formatInteger(out, value);
+  }
+
+  template <typename T>
+  static char* formatNumber(char* out, T value, std::true_type) {
+#ifdef QS_HAS_FLOAT_CHARCONV
+    return formatFloating(out, value);
+#else
+    return formatDouble(out, double(value));
+#endif
+  }
+
+  /* Number of type T spelled by all of [begin, end); from_chars where the
+   * library has it for T, fromText() for the rest */
+  template <typename T>
+  static T fromChars(const char* begin, const char* end) {
+    T value;
+    if (fromChars(begin, end, value, std::is_floating_point<T>())) {
+      return value;
+    }
+    return fromText<T>(QString::fromLatin1(begin, int(end - begin)));
+  }
+
+  template <typename T>
+  static bool fromChars(const char* begin, const char* end, T& value,
+                        std::false_type) {
+#ifdef QS_HAS_CHARCONV
+    std::from_chars_result result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+#else
+    Q_UNUSED(begin);
+    Q_UNUSED(end);
+    Q_UNUSED(value);
+    return false;
+#endif
+  }
+
+  template <typename T>
+  static bool fromChars(const char* begin, const char* end, T& value,
+                        std::true_type) {
+#ifdef QS_HAS_FLOAT_CHARCONV
+    std::from_chars_result result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+#else
+    Q_UNUSED(begin);
+    Q_UNUSED(end);
+    Q_UNUSED(value);
+    return false;
+#endif
+  }
+
+  template <typename T>
+  static T parseFloating(const QString& text) {
+#ifdef QS_HAS_FLOAT_CHARCONV
+    char chars[kNumberBufferSize];
+    const char* end = chars + numberChars(text, chars);
+    T value;
+    std::from_chars_result result =
+        std::from_chars(skipPlus(chars, end), end, value);
+    if (end != chars && result.ptr == end && result.ec == std::errc()) {
+      return value;
+    }
+#endif
+    return QVariant(text).value<T>();
+  }
+
+ public:
+
+#ifdef QS_HAS_JSON
+  /*! \brief  Compact JSON text writer used by toRawJson(). Strings are
+   * escaped and converted from UTF-16 to UTF-8 by vector kernels that copy
+   * runs of plain ASCII 16 or 32 characters at a time; only quotes,
+   * backslashes, control and non-ASCII characters take the scalar path.
+   * On Qt 6 the output matches QJsonDocument::Compact byte for byte. Qt 5
+   * releases format some numbers differently (1e+06 for 1000000 in older
+   * ones), so there the text may differ while the values are the same. */
+  class JsonWriter {
+   public:
+    /*! \brief  Compact text of object. The buffer is allocated once for
+     * sizeHint bytes (a previous output size, say), or for estimate() when
+     * the hint is 0, and only grows if the text turns out longer. */
+    static QByteArray write(const QJsonObject& object, qint64 sizeHint = 0) {
+      JsonWriter writer;
+      writer.allocate(sizeHint > 0 ? sizeHint : estimate(object));
+      writer.writeObject(object);
+      return writer.take();
+    }
+
+    static QByteArray write(const QJsonArray& array) {
+      JsonWriter writer;
+      writer.writeArray(array);
+      return writer.take();
+    }
+
+    /*! \brief  Near size of the compact text of value, from one walk over
+     * it: exact for the structure, keys, literals and ASCII strings without
+     * escapes, at most 24 bytes for a number. */
+    static qint64 estimate(const QJsonValue& value) {
+      switch (value.type()) {
+        case QJsonValue::Bool:
+          return value.toBool() ? 4 : 5;
+        case QJsonValue::Double:
+          return estimateNumber(value.toDouble());
+        case QJsonValue::String:
+          return value.toString().size() + 2;
+        case QJsonValue::Array: {
+          const QJsonArray array = value.toArray();
+          // brackets and a comma per element, one too many
+          qint64 size = 2 + array.size();
+          for (const QJsonValue element : array) size += estimate(element);
+          return size;
+        }
+        case QJsonValue::Object:
+          return estimate(value.toObject());
+        default:
+          return 4;
+      }
+    }
+
+    static qint64 estimate(const QJsonObject& object) {
+      qint64 size = 2;
+      for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        // "key": and a comma
+        size += it.key().size() + 4 + estimate(it.value());
+      }
+      return size;
+    }
+
+   private:
+    typedef const char16_t* (*AsciiKernel)(const char16_t* src,
+                                           const char16_t* end, char*& dst);
+
+    static qint64 estimateNumber(double value) {
+      if (!std::isfinite(value)) return 4;
+      if (value != std::floor(value) ||
+          std::fabs(value) >= 9007199254740992.0) {
+        return 24;
+      }
+      qint64 digits = value < 0 ? 2 : 1;
+      for (double rest = std::fabs(value); rest >= 10; rest /= 10) ++digits;
+      return digits;
+    }
+
+    /* Buffer for size bytes, with room for a number at the end */
+    void allocate(qint64 size) {
+      m_buffer.resize(size + kNumberBufferSize);
+      m_pos = m_buffer.data();
+      m_end = m_buffer.data() + m_buffer.size();
+    }
+
+    /* Room for n more bytes at m_pos */
+    char* reserve(qsizetype n) {
+      if (m_end - m_pos < n) {
+        qsizetype used = m_pos - m_buffer.data();
+        m_buffer.resize(
+            qMax<qsizetype>(used + n, 2 * qsizetype(m_buffer.size()) + 64));
+        m_pos = m_buffer.data() + used;
+        m_end = m_buffer.data() + m_buffer.size();
+      }
+      return m_pos;
+    }
+
+    void put(char c) { *reserve(1) = c; ++m_pos; }
+
+    void put(const char* text, qsizetype size) {
+      std::memcpy(reserve(size), text, size);
+      m_pos += size;
+    }
+
+    QByteArray take() {
+      const qsizetype size = m_pos - m_buffer.data();
+      m_buffer.resize(size);
+      // do not hand out a buffer much larger than the text it holds
+      if (m_buffer.capacity() - size > size / 8 + 64) m_buffer.squeeze();
+      return std::move(m_buffer);
+    }
+
+    void writeValue(const QJsonValue& value) {
+      switch (value.type()) {
+        case QJsonValue::Bool:
+          value.toBool() ? put("true", 4) : put("false", 5);
+          break;
+        case QJsonValue::Double:
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+          // Qt 6 stores integers apart from doubles and writes them in full
+          if (QCborValue::fromJsonValue(value).isInteger()) {
+            writeInteger(value.toInteger());
+            break;
+          }
+#endif
+          writeNumber(value.toDouble());
+          break;
+        case QJsonValue::String:
+          writeString(value.toString());
+          break;
+        case QJsonValue::Array:
+          writeArray(value.toArray());
+          break;
+        case QJsonValue::Object:
+          writeObject(value.toObject());
+          break;
+        default:
+          put("null", 4);
+          break;
+      }
+    }
+
+    void writeObject(const QJsonObject& object) {
+      put('{');
+      bool first = true;
+      for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        if (!first) put(',');
+        first = false;
+        writeString(it.key());
+        put(':');
+        writeValue(it.value());
+      }
+      put('}');
+    }
+
+    void writeArray(const QJsonArray& array) {
+      put('[');
+      bool first = true;
+      for (const QJsonValue value : array) {
+        if (!first) put(',');
+        first = false;
+        writeValue(value);
+      }
+      put(']');
+    }
+
+    void writeNumber(double value) {
+      if (!std::isfinite(value)) {
+        put("null", 4);
+        return;
+      }
+      char* dst = reserve(kNumberBufferSize);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+      // Qt 5 keeps every number as a double; integral ones are written in
+      // full
+      if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        m_pos = formatInteger(dst, qint64(value));
+        return;
+      }
+#endif
+      m_pos = formatDouble(dst, value);
+    }
+
+    void writeInteger(qint64 value) {
+      m_pos = formatInteger(reserve(kNumberBufferSize), value);
+    }
+
+    void writeString(const QString& str) {
+      const char16_t* src = reinterpret_cast<const char16_t*>(str.utf16());
+      const char16_t* end = src + str.size();
+      AsciiKernel copyAscii = asciiKernel();
+      put('"');
+      // every unit takes at least one byte
+      char* dst = reserve(end - src);
+      while (src != end) {
+        src = copyAscii(src, end, dst);
+        if (src == end) break;
+        // and one that needs escaping or encoding up to six
+        if (m_end - dst < (end - src) + 5) {
+          m_pos = dst;
+          dst = reserve((end - src) + 5);
+        }
+        dst = writeUnit(src, end, dst);
+      }
+      m_pos = dst;
+      put('"');
+    }
+
+    /* One unit (or surrogate pair) that may need escaping or encoding */
+    static char* writeUnit(const char16_t*& src, const char16_t* end,
+                           char* dst) {
+      static const char hex[] = "0123456789abcdef";
+      char32_t c = *src++;
+      if (c < 0x80) {
+        switch (c) {
+          case '"': *dst++ = '\\'; *dst++ = '"'; break;
+          case '\\': *dst++ = '\\'; *dst++ = '\\'; break;
+          case '\b': *dst++ = '\\'; *dst++ = 'b'; break;
+          case '\f': *dst++ = '\\'; *dst++ = 'f'; break;
+          case '\n': *dst++ = '\\'; *dst++ = 'n'; break;
+          case '\r': *dst++ = '\\'; *dst++ = 'r'; break;
+          case '\t': *dst++ = '\\'; *dst++ = 't'; break;
+          default:
+            if (c < 0x20) {
+              std::memcpy(dst, "\\u00", 4);
+              dst[4] = hex[c >> 4];
+              dst[5] = hex[c & 0xf];
+              dst += 6;
+            } else {
+              *dst++ = char(c);
+            }
+        }
+        return dst;
+      }
+      if (c < 0x800) {
+        *dst++ = char(0xc0 | (c >> 6));
+        *dst++ = char(0x80 | (c & 0x3f));
+        return dst;
+      }
+      if (c >= 0xd800 && c < 0xe000) {
+        if (c < 0xdc00 && src != end && *src >= 0xdc00 && *src < 0xe000) {
+          c = 0x10000 + ((c - 0xd800) << 10) + (*src++ - 0xdc00);
+          *dst++ = char(0xf0 | (c >> 18));
+          *dst++ = char(0x80 | ((c >> 12) & 0x3f));
+          *dst++ = char(0x80 | ((c >> 6) & 0x3f));
+          *dst++ = char(0x80 | (c & 0x3f));
+          return dst;
+        }
+        // unpaired surrogate, escaped as QJsonDocument does
+        std::memcpy(dst, "\\u", 2);
+        dst[2] = hex[c >> 12];
+        dst[3] = hex[(c >> 8) & 0xf];
+        dst[4] = hex[(c >> 4) & 0xf];
+        dst[5] = hex[c & 0xf];
+        return dst + 6;
+      }
+      *dst++ = char(0xe0 | (c >> 12));
+      *dst++ = char(0x80 | ((c >> 6) & 0x3f));
+      *dst++ = char(0x80 | (c & 0x3f));
+      return dst;
+    }
+
+    /* The kernels copy units that need neither escaping nor multi-byte
+     * encoding and return the first one that does (or the short tail).
+     * They may store a few bytes past the copied run, never more than one
+     * per unit up to end; writeString reserved room for them. */
+    static const char16_t* copyAsciiScalar(const char16_t* src,
+                                           const char16_t* end, char*& dst) {
+      while (src != end && *src >= 0x20 && *src < 0x80 && *src != '"' &&
+             *src != '\\') {
+        *dst++ = char(*src++);
+      }
+      return src;
+    }
+
+#ifdef QS_JSON_SSE2
+    /* All-ones in the 16-bit lanes of plain ASCII units */
+    static __m128i plainSse2(__m128i v) {
+      const __m128i ascii = _mm_cmpeq_epi16(
+          _mm_and_si128(v, _mm_set1_epi16(short(0xff80))),
+          _mm_setzero_si128());
+      const __m128i special = _mm_or_si128(
+          _mm_cmplt_epi16(v, _mm_set1_epi16(0x20)),
+          _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('"')),
+                       _mm_cmpeq_epi16(v, _mm_set1_epi16('\\'))));
+      return _mm_andnot_si128(special, ascii);
+    }
+
+    static const char16_t* copyAsciiSse2(const char16_t* src,
+                                         const char16_t* end, char*& dst) {
+      while (end - src >= 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i b =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+        unsigned plain = unsigned(_mm_movemask_epi8(
+            _mm_packs_epi16(plainSse2(a), plainSse2(b))));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                         _mm_packus_epi16(a, b));
+        if (plain != 0xffff) {
+          unsigned n = trailingZeros(~plain);
+          dst += n;
+          return src + n;
+        }
+        dst += 16;
+        src += 16;
+      }
+      return copyAsciiScalar(src, end, dst);
+    }
+#endif
+
+#ifdef QS_JSON_AVX2
+    __attribute__((target("avx2"))) static __m256i plainAvx2(__m256i v) {
+      const __m256i ascii = _mm256_cmpeq_epi16(
+          _mm256_and_si256(v, _mm256_set1_epi16(short(0xff80))),
+          _mm256_setzero_si256());
+      const __m256i special = _mm256_or_si256(
+          _mm256_cmpgt_epi16(_mm256_set1_epi16(0x20), v),
+          _mm256_or_si256(_mm256_cmpeq_epi16(v, _mm256_set1_epi16('"')),
+                          _mm256_cmpeq_epi16(v, _mm256_set1_epi16('\\'))));
+      return _mm256_andnot_si256(special, ascii);
+    }
+
+    __attribute__((target("avx2"))) static const char16_t* copyAsciiAvx2(
+        const char16_t* src, const char16_t* end, char*& dst) {
+      while (end - src >= 32) {
+        __m256i a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 16));
+        // packs works per 128-bit lane; restore the unit order
+        unsigned plain = unsigned(_mm256_movemask_epi8(_mm256_permute4x64_epi64(
+            _mm256_packs_epi16(plainAvx2(a), plainAvx2(b)), 0xd8)));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst),
+            _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8));
+        if (plain != 0xffffffffu) {
+          unsigned n = trailingZeros(~plain);
+          dst += n;
+          return src + n;
+        }
+        dst += 32;
+        src += 32;
+      }
+      return copyAsciiSse2(src, end, dst);
+    }
+#endif
+
+    /* Best kernel for this CPU, chosen once */
+    static AsciiKernel asciiKernel() {
+      static const AsciiKernel kernel = [] {
+#ifdef QS_JSON_AVX2
+        if (__builtin_cpu_supports("avx2")) return &copyAsciiAvx2;
+#endif
+#ifdef QS_JSON_SSE2
+        return &copyAsciiSse2;
+#else
+        return &copyAsciiScalar;
+#endif
+      }();
+      return kernel;
+    }
+
+    QByteArray m_buffer;
+    char* m_pos = nullptr;
+    char* m_end = nullptr;
+  };
+#endif
+
+#ifdef QS_HAS_JSON
+#ifdef QS_FAST_JSON_PARSER
+  /*! \brief  JSON parser used by fromJson(const QByteArray&) when
+   * QS_FAST_JSON_PARSER is defined. Vector kernels find the end of string
+   * bodies (the next quote, backslash or control character) and of
+   * whitespace runs 16 or 32 bytes at a time, and strings without escapes
+   * are decoded from the input in one step. Input it does not accept,
+   * including all invalid JSON, is left to QJsonDocument. */
+  class JsonReader {
+   public:
+    /*! \brief  Parse a document whose root is an object; false when the
+     * input has to go through QJsonDocument instead. */
+    static bool parse(const QByteArray& data, QJsonObject& object) {
+      JsonReader reader(data.constData(), data.constData() + data.size());
+      reader.skipSpace();
+      if (reader.m_pos == reader.m_end || *reader.m_pos != '{' ||
+          !reader.parseObject(object, 0)) {
+        return false;
+      }
+      reader.skipSpace();
+      return reader.m_pos == reader.m_end;
+    }
+
+   private:
+    typedef const char* (*Scanner)(const char* pos, const char* end);
+
+    /* Nesting limit of QJsonDocument */
+    static const int kMaxDepth = 1024;
+
+    JsonReader(const char* begin, const char* end)
+        : m_pos(begin), m_end(end) {}
+
+    static bool isSpace(char c) {
+      return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    void skipSpace() {
+      if (m_pos != m_end && isSpace(*m_pos)) {
+        m_pos = kernels().skipSpace(m_pos, m_end);
+      }
+    }
+
+    bool parseValue(QJsonValue& value, int depth) {
+      if (m_pos == m_end) return false;
+      switch (*m_pos) {
+        case '{': {
+          QJsonObject object;
+          if (!parseObject(object, depth + 1)) return false;
+          value = QJsonValue(std::move(object));
+          return true;
+        }
+        case '[': {
+          QJsonArray array;
+          if (!parseArray(array, depth + 1)) return false;
+          value = QJsonValue(std::move(array));
+          return true;
+        }
+        case '"': {
+          QString str;
+          if (!parseString(str)) return false;
+          value = QJsonValue(std::move(str));
+          return true;
+        }
+        case 't':
+          value = QJsonValue(true);
+          return literal("true", 4);
+        case 'f':
+          value = QJsonValue(false);
+          return literal("false", 5);
+        case 'n':
+          value = QJsonValue();
+          return literal("null", 4);
+        default:
+          return parseNumber(value);
+      }
+    }
+
+    bool literal(const char* word, std::size_t size) {
+      if (std::size_t(m_end - m_pos) < size ||
+          std::memcmp(m_pos, word, size) != 0) {
+        return false;
+      }
+      m_pos += size;
+      return true;
+    }
+
+    bool parseObject(QJsonObject& object, int depth) {
+      if (depth > kMaxDepth) return false;
+      ++m_pos;
+      skipSpace();
+      std::vector<std::pair<QString, QJsonValue>> members;
+      if (m_pos != m_end && *m_pos == '}') {
+        ++m_pos;
+        return true;
+      }
+      for (;;) {
+        if (m_pos == m_end || *m_pos != '"') return false;
+        QString key;
+        if (!parseString(key)) return false;
+        skipSpace();
+        if (m_pos == m_end || *m_pos != ':') return false;
+        ++m_pos;
+        skipSpace();
+        QJsonValue value;
+        if (!parseValue(value, depth)) return false;
+        members.emplace_back(std::move(key), std::move(value));
+        skipSpace();
+        if (m_pos == m_end) return false;
+        if (*m_pos == '}') break;
+        if (*m_pos != ',') return false;
+        ++m_pos;
+        skipSpace();
+      }
+      ++m_pos;
+      // QJsonObject keeps its keys sorted, so sorted inserts only append;
+      // the stable sort lets the last of duplicate keys win
+      std::stable_sort(members.begin(), members.end(),
+                       [](const std::pair<QString, QJsonValue>& a,
+                          const std::pair<QString, QJsonValue>& b) {
+                         return a.first < b.first;
+                       });
+      for (std::pair<QString, QJsonValue>& member : members) {
+        object.insert(member.first, member.second);
+      }
+      return true;
+    }
+
+    bool parseArray(QJsonArray& array, int depth) {
+      if (depth > kMaxDepth) return false;
+      ++m_pos;
+      skipSpace();
+      if (m_pos != m_end && *m_pos == ']') {
+        ++m_pos;
+        return true;
+      }
+      for (;;) {
+        QJsonValue value;
+        if (!parseValue(value, depth)) return false;
+        array.append(value);
+        skipSpace();
+        if (m_pos == m_end) return false;
+        if (*m_pos == ']') break;
+        if (*m_pos != ',') return false;
+        ++m_pos;
+        skipSpace();
+      }
+      ++m_pos;
+      return true;
+    }
+
+    bool parseString(QString& str) {
+      const char* start = ++m_pos;
+      const char* pos = kernels().scanString(start, m_end);
+      if (pos == m_end || uchar(*pos) < 0x20) return false;
+      if (*pos == '"') {
+        str = QString::fromUtf8(start, int(pos - start));
+        m_pos = pos + 1;
+        return validUtf8(str, start, pos);
+      }
+      std::string buffer(start, pos);
+      while (*pos == '\\') {
+        if (++pos == m_end) return false;
+        switch (*pos++) {
+          case '"': buffer += '"'; break;
+          case '\\': buffer += '\\'; break;
+          case '/': buffer += '/'; break;
+          case 'b': buffer += '\b'; break;
+          case 'f': buffer += '\f'; break;
+          case 'n': buffer += '\n'; break;
+          case 'r': buffer += '\r'; break;
+          case 't': buffer += '\t'; break;
+          case 'u':
+            if (!unescapeUnicode(pos, buffer)) return false;
+            break;
+          default:
+            return false;
+        }
+        const char* next = kernels().scanString(pos, m_end);
+        if (next == m_end || uchar(*next) < 0x20) return false;
+        buffer.append(pos, next);
+        pos = next;
+      }
+      str = QString::fromUtf8(buffer.data(), int(buffer.size()));
+      m_pos = pos + 1;
+      return validUtf8(str, buffer.data(), buffer.data() + buffer.size());
+    }
+
+    /* fromUtf8 replaces invalid sequences with U+FFFD; QJsonDocument
+     * rejects them, so such input is left to it */
+    static bool validUtf8(const QString& str, const char* begin,
+                          const char* end) {
+      return !str.contains(QChar(QChar::ReplacementCharacter)) ||
+             QByteArray::fromRawData(begin, int(end - begin))
+                 .contains("\xef\xbf\xbd");
+    }
+
+    static int hexDigit(char c) {
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+      return -1;
+    }
+
+    bool readHex4(const char*& pos, char32_t& unit) {
+      if (m_end - pos < 4) return false;
+      unit = 0;
+      for (int i = 0; i < 4; i++) {
+        int digit = hexDigit(*pos++);
+        if (digit < 0) return false;
+        unit = (unit << 4) | char32_t(digit);
+      }
+      return true;
+    }
+
+    /* \uXXXX (pos after the u), or a \uD8XX\uDCXX pair, as UTF-8 */
+    bool unescapeUnicode(const char*& pos, std::string& buffer) {
+      char32_t c;
+      if (!readHex4(pos, c)) return false;
+      if (c >= 0xd800 && c < 0xe000) {
+        char32_t low;
+        if (c >= 0xdc00 || m_end - pos < 6 || pos[0] != '\\' ||
+            pos[1] != 'u') {
+          return false;
+        }
+        pos += 2;
+        if (!readHex4(pos, low) || low < 0xdc00 || low >= 0xe000) {
+          return false;
+        }
+        c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+      }
+      if (c < 0x80) {
+        buffer += char(c);
+      } else if (c < 0x800) {
+        buffer += char(0xc0 | (c >> 6));
+        buffer += char(0x80 | (c & 0x3f));
+      } else if (c < 0x10000) {
+        buffer += char(0xe0 | (c >> 12));
+        buffer += char(0x80 | ((c >> 6) & 0x3f));
+        buffer += char(0x80 | (c & 0x3f));
+      } else {
+        buffer += char(0xf0 | (c >> 18));
+        buffer += char(0x80 | ((c >> 12) & 0x3f));
+        buffer += char(0x80 | ((c >> 6) & 0x3f));
+        buffer += char(0x80 | (c & 0x3f));
+      }
+      return true;
+    }
+
+    /* Integers that fit are stored as integers, like QJsonDocument does
+     * (Qt 6); everything else as double */
+    bool parseNumber(QJsonValue& value) {
+      const char* start = m_pos;
+      const char* pos = m_pos;
+      if (pos != m_end && *pos == '-') ++pos;
+      const char* digits = pos;
+      while (pos != m_end && *pos >= '0' && *pos <= '9') ++pos;
+      std::ptrdiff_t intDigits = pos - digits;
+      if (intDigits == 0 || (intDigits > 1 && *digits == '0')) return false;
+      bool integer = true;
+      if (pos != m_end && *pos == '.') {
+        integer = false;
+        const char* fraction = ++pos;
+        while (pos != m_end && *pos >= '0' && *pos <= '9') ++pos;
+        if (pos == fraction) return false;
+      }
+      if (pos != m_end && (*pos == 'e' || *pos == 'E')) {
+        integer = false;
+        ++pos;
+        if (pos != m_end && (*pos == '+' || *pos == '-')) ++pos;
+        const char* exponent = pos;
+        while (pos != m_end && *pos >= '0' && *pos <= '9') ++pos;
+        if (pos == exponent) return false;
+      }
+      m_pos = pos;
+      if (integer && intDigits <= 18) {
+        qint64 n = 0;
+        for (const char* d = digits; d != pos; ++d) n = n * 10 + (*d - '0');
+        if (*start == '-') n = -n;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        value = QJsonValue(n);
+#else
+        value = QJsonValue(double(n));
+#endif
+        return true;
+      }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) && defined(QS_HAS_CHARCONV)
+      // 19 digits may still fit; QJsonDocument keeps those exact and only
+      // turns integers out of range into doubles
+      if (integer) {
+        qint64 n = 0;
+        if (std::from_chars(start, pos, n).ec == std::errc()) {
+          value = QJsonValue(n);
+          return true;
+        }
+      }
+#endif
+      bool ok = false;
+      double d = QByteArray::fromRawData(start, int(pos - start)).toDouble(&ok);
+      value = QJsonValue(d);
+      return ok;
+    }
+
+    /* First quote, backslash or control character at or after pos */
+    static const char* scanStringScalar(const char* pos, const char* end) {
+      while (pos != end && *pos != '"' && *pos != '\\' && uchar(*pos) >= 0x20) {
+        ++pos;
+      }
+      return pos;
+    }
+
+    /* First byte at or after pos that is not whitespace */
+    static const char* skipSpaceScalar(const char* pos, const char* end) {
+      while (pos != end && isSpace(*pos)) ++pos;
+      return pos;
+    }
+
+#ifdef QS_JSON_SSE2
+    static const char* scanStringSse2(const char* pos, const char* end) {
+      while (end - pos >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        __m128i stop = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+            // unsigned v <= 0x1f
+            _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v));
+        unsigned mask = unsigned(_mm_movemask_epi8(stop));
+        if (mask) return pos + trailingZeros(mask);
+        pos += 16;
+      }
+      return scanStringScalar(pos, end);
+    }
+
+    static const char* skipSpaceSse2(const char* pos, const char* end) {
+      while (end - pos >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        __m128i space = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+        unsigned mask = unsigned(_mm_movemask_epi8(space)) ^ 0xffffu;
+        if (mask) return pos + trailingZeros(mask);
+        pos += 16;
+      }
+      return skipSpaceScalar(pos, end);
+    }
+#endif
+
+#ifdef QS_JSON_AVX2
+    __attribute__((target("avx2"))) static const char* scanStringAvx2(
+        const char* pos, const char* end) {
+      while (end - pos >= 32) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+        __m256i stop = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)),
+                              v));
+        unsigned mask = unsigned(_mm256_movemask_epi8(stop));
+        if (mask) return pos + trailingZeros(mask);
+        pos += 32;
+      }
+      return scanStringSse2(pos, end);
+    }
+
+    __attribute__((target("avx2"))) static const char* skipSpaceAvx2(
+        const char* pos, const char* end) {
+      while (end - pos >= 32) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+        __m256i space = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))));
+        unsigned mask = ~unsigned(_mm256_movemask_epi8(space));
+        if (mask) return pos + trailingZeros(mask);
+        pos += 32;
+      }
+      return skipSpaceSse2(pos, end);
+    }
+#endif
+
+    struct Kernels {
+      Scanner scanString;
+      Scanner skipSpace;
+    };
+
+    /* Best kernels for this CPU, chosen once */
+    static const Kernels& kernels() {
+      static const Kernels kernels = [] {
+#ifdef QS_JSON_AVX2
+        if (__builtin_cpu_supports("avx2")) {
+          return Kernels{&scanStringAvx2, &skipSpaceAvx2};
+        }
+#endif
+#ifdef QS_JSON_SSE2
+        return Kernels{&scanStringSse2, &skipSpaceSse2};
+#else
+        return Kernels{&scanStringScalar, &skipSpaceScalar};
+#endif
+      }();
+      return kernels;
+    }
+
+    const char* m_pos;
+    const char* m_end;
+  };
+#endif
+
+  /*! \brief  Parse raw JSON, through JsonReader when it is enabled. */
+  static QJsonDocument parseJson(const QByteArray& data) {
+#ifdef QS_FAST_JSON_PARSER
+    QJsonObject object;
+    if (JsonReader::parse(data, object)) return QJsonDocument(object);
+#endif
+    return QJsonDocument::fromJson(data);
+  }
+
+  /*! \brief  Convert QJsonValue in QJsonDocument as QByteArray. */
+  static QByteArray toByteArray(const QJsonValue& value,
+                                qint64 sizeHint = 0) {
+    if (QS_JSON_DOC_MODE == QJsonDocument::Compact) {
+      return JsonWriter::write(value.toObject(), sizeHint);
+    }
+    return QJsonDocument(value.toObject()).toJson(QS_JSON_DOC_MODE);
+  }
+
+  /*! \brief  Bytes of the compact JSON text of value. */
+  static qint64 jsonSize(const QJsonValue& value) {
+    QJsonDocument doc;
+    if (value.isObject()) {
+      doc.setObject(value.toObject());
+    } else if (value.isArray()) {
+      doc.setArray(value.toArray());
+    } else {
+      // scalars need a container; its brackets are not counted
+      doc.setArray(QJsonArray{value});
+      return doc.toJson(QJsonDocument::Compact).size() - 2;
+    }
+    return doc.toJson(QJsonDocument::Compact).size();
+  }
+
+
+  /*! \brief  Convert a member value to JSON. Strings, numbers and JSON
+   * containers are wrapped directly, other types go through QVariant. */
+  template <typename T>
+  static QJsonValue toJsonValue(const T& value) {
+    return QJsonValue::fromVariant(QVariant(value));
+  }
+
+  static QJsonValue toJsonValue(bool value) { return QJsonValue(value); }
+  static QJsonValue toJsonValue(int value) { return QJsonValue(value); }
+  static QJsonValue toJsonValue(qint64 value) { return QJsonValue(value); }
+  static QJsonValue toJsonValue(double value) { return QJsonValue(value); }
+
+  static QJsonValue toJsonValue(float value) {
+    return QJsonValue(double(value));
+  }
+
+  static QJsonValue toJsonValue(const QString& value) {
+    return QJsonValue(value);
+  }
+
+  static QJsonValue toJsonValue(const QStringList& value) {
+    return QJsonValue(QJsonArray::fromStringList(value));
+  }
+
+  static QJsonValue toJsonValue(const QJsonValue& value) { return value; }
+
+  static QJsonValue toJsonValue(const QJsonArray& value) {
+    return QJsonValue(value);
+  }
+
+  static QJsonValue toJsonValue(const QJsonObject& value) {
+    return QJsonValue(value);
+  }
+
+  /*! \brief  Convert a JSON value to a member of type T. Strings, numbers
+   * and JSON containers are taken over without the QVariant round trip,
+   * which would copy them (and deep-convert arrays and objects) twice. */
+  template <typename T>
+  static T fromJsonValue(const QJsonValue& value) {
+    return fromJsonValue(value, static_cast<T*>(nullptr));
+  }
+
+ private:
+  template <typename T>
+  static T fromJsonValue(const QJsonValue& value, T*) {
+    return value.toVariant().value<T>();
+  }
+
+  static double fromJsonValue(const QJsonValue& value, double*) {
+    if (value.isDouble()) return value.toDouble();
+    return value.toVariant().value<double>();
+  }
+
+  static float fromJsonValue(const QJsonValue& value, float*) {
+    if (value.isDouble()) return float(value.toDouble());
+    return value.toVariant().value<float>();
+  }
+
+  static int fromJsonValue(const QJsonValue& value, int*) {
+    return integerFromJson<int>(value);
   }
 
-  bool shouldSkipMemberEmpty(const char* memberName) const {
-    auto it = s_memberOptions.find(metaObject()->className());
-    if (it != s_memberOptions.end()) {
-      for (const auto& opt : it->second) {
-        if (opt.memberName == memberName) {
-          return opt.skipEmpty;
-        }
-      }
-    }
-    return shouldSkipEmpty();  // If there is no member-level setting, use the
-                               // class-level setting
+  static qint64 fromJsonValue(const QJsonValue& value, qint64*) {
+    return integerFromJson<qint64>(value);
   }
 
-  bool shouldSkipMemberNull(const char* memberName) const {
-    auto it = s_memberOptions.find(metaObject()->className());
-    if (it != s_memberOptions.end()) {
-      for (const auto& opt : it->second) {
-        if (opt.memberName == memberName) {
-          return opt.skipNull;
-        }
+  /* Whole numbers that T holds exactly are taken directly; the others keep
+   * the rounding and clamping of QVariant */
+  template <typename T>
+  static T integerFromJson(const QJsonValue& value) {
+    if (value.isDouble()) {
+      double d = value.toDouble();
+      if (d == std::floor(d) && std::fabs(d) < 9007199254740992.0 &&
+          d >= double(std::numeric_limits<T>::min()) &&
+          d <= double(std::numeric_limits<T>::max())) {
+        return T(d);
       }
     }
-    return shouldSkipNull();
+    return value.toVariant().value<T>();
   }
 
-  bool shouldSkipMemberNullLiterals(const char* memberName) const {
-    auto it = s_memberOptions.find(metaObject()->className());
-    if (it != s_memberOptions.end()) {
-      for (const auto& opt : it->second) {
-        if (opt.memberName == memberName) {
-          return opt.skipNullLiterals;
-        }
-      }
-    }
-    return shouldSkipNullLiterals();
+  static QString fromJsonValue(const QJsonValue& value, QString*) {
+    if (value.isString()) return value.toString();
+    return value.toVariant().value<QString>();
   }
 
-  bool shouldSkipEmpty() const {
-    return getClassOptions(metaObject()->className()).skipEmpty;
+  static QStringList fromJsonValue(const QJsonValue& value, QStringList*) {
+    if (!value.isArray()) return value.toVariant().value<QStringList>();
+    QJsonArray array = value.toArray();
+    QStringList list;
+    list.reserve(array.size());
+    for (const QJsonValue item : array) {
+      if (!item.isString()) return value.toVariant().value<QStringList>();
+      list.append(item.toString());
+    }
+    return list;
   }
 
-  bool shouldSkipNull() const {
-    return getClassOptions(metaObject()->className()).skipNull;
+  static QJsonValue fromJsonValue(const QJsonValue& value, QJsonValue*) {
+    return value;
   }
 
-  bool shouldSkipNullLiterals() const {
-    return getClassOptions(metaObject()->className()).skipNullLiterals;
+  static QJsonArray fromJsonValue(const QJsonValue& value, QJsonArray*) {
+    return value.toArray();
   }
 
-#ifdef QS_HAS_JSON
-  /*! \brief  Convert QJsonValue in QJsonDocument as QByteArray. */
-  static QByteArray toByteArray(const QJsonValue& value) {
-    return QJsonDocument(value.toObject()).toJson(QS_JSON_DOC_MODE);
+  static QJsonObject fromJsonValue(const QJsonValue& value, QJsonObject*) {
+    return value.toObject();
   }
+
+ public:
 #endif
 
 #ifdef QS_HAS_XML
   /*! \brief  Convert QDomNode in QDomDocument as QByteArray. */
-  static QByteArray toByteArray(const QDomNode& value) {
+  static QByteArray toByteArray(const QDomNode& value, qint64 sizeHint = 0) {
     QDomDocument doc = value.toDocument();
-    return doc.toByteArray();
+    if (sizeHint <= 0) return doc.toByteArray();
+    // what toByteArray() does, written straight into a buffer allocated once
+    QByteArray text;
+    text.reserve(int(sizeHint + sizeHint / 16));
+    QTextStream stream(&text);
+    setUtf8(stream);
+    doc.save(stream, 1);
+    stream.flush();
+    return text;
+  }
+
+  /*! \brief  Make stream write UTF-8 like QDomDocument::toByteArray; on
+   * Qt 5 it would use the codec of the locale. */
+  static void setUtf8(QTextStream& stream) {
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    stream.setCodec("UTF-8");
+#else
+    stream.setEncoding(QStringConverter::Utf8);
+#endif
+  }
+
+  /*! \brief  Bytes of the XML text of node without indentation and line
+   * breaks, so that the size of an element does not depend on its depth. */
+  static qint64 xmlSize(const QDomNode& node) {
+    QByteArray text;
+    QTextStream stream(&text);
+    setUtf8(stream);
+    node.save(stream, -1);
+    stream.flush();
+    return text.size();
+  }
+
+  /*! \brief  Bytes of attribute in its element: the separating space and
+   * name="value", escaped. */
+  static qint64 xmlAttributeSize(const QDomAttr& attribute) {
+    QDomDocument doc;
+    QDomElement element = doc.createElement("_");
+    element.setAttribute(attribute.name(), attribute.value());
+    // <_ name="value"/>
+    return xmlSize(element) - 4;
   }
 
   /*! \brief  Make xml processing instruction (hat) and returns new XML
@@ -219,12 +2852,184 @@ class QSerializer {
     doc.insertBefore(xmlNode, doc.firstChild());
     return doc;
   }
+
+  /*! \brief  Collect the child elements of node into a vector allocated from
+   * the arena of the current context. */
+  static ScratchVector<QDomElement> childElements(const QDomNode& node) {
+    ScratchVector<QDomElement> elements = makeScratchVector<QDomElement>();
+    std::size_t count = 0;
+    for (QDomElement e = node.firstChildElement(); !e.isNull();
+         e = e.nextSiblingElement()) {
+      ++count;
+    }
+    elements.reserve(count);
+    for (QDomElement e = node.firstChildElement(); !e.isNull();
+         e = e.nextSiblingElement()) {
+      elements.push_back(e);
+    }
+    return elements;
+  }
+
+  /*! \brief  Update mode of the XML dictionary setters: erase the entries
+   * of map whose key is not among the "key" attributes of items, as the
+   * JSON setters do with the keys of the incoming object. */
+  template <typename Map>
+  static void eraseMissingKeys(Map& map,
+                               const ScratchVector<QDomElement>& items) {
+    ScratchVector<QString> keys = makeScratchVector<QString>();
+    keys.reserve(items.size());
+    for (const QDomElement& item : items) keys.push_back(item.attribute("key"));
+    std::sort(keys.begin(), keys.end());
+    for (auto p = map.begin(); p != map.end();) {
+      if (std::binary_search(keys.begin(), keys.end(), toText(dictKey(p, 0))))
+        ++p;
+      else
+        p = map.erase(p);
+    }
+  }
+
+  /*! \brief  Write a collection of numbers into element in a packed form,
+   * marked by a "packed" attribute. False for XmlNumberItems and for other
+   * element types, which are written as <item> elements. */
+  template <typename Container>
+  static bool packXmlNumbers(QDomDocument& doc, QDomElement& element,
+                             const Container& numbers, XmlNumbers form) {
+    return packXmlNumbers(doc, element, numbers, form,
+                          IsPackable<typename Container::value_type>());
+  }
+
+  /*! \brief  Read a collection written by packXmlNumbers() into numbers,
+   * which is empty. False when node holds <item> elements instead. */
+  template <typename Container>
+  static bool unpackXmlNumbers(const QDomNode& node, Container& numbers) {
+    return unpackXmlNumbers(node, numbers,
+                            IsPackable<typename Container::value_type>());
+  }
+
+  /*! \brief  The document toXml() is building while it reads the member
+   * memberName of this object; null anywhere else. */
+  QDomDocument* xmlMemberDocument(const char* memberName) const {
+    SerializationContext* ctx = SerializationContext::current();
+    if (!ctx || !ctx->m_memberDocument || ctx->m_memberOwner != this ||
+        std::strcmp(ctx->m_memberName, memberName) != 0) {
+      return nullptr;
+    }
+    return ctx->m_memberDocument;
+  }
+
+  /*! \brief  The name="text" node QS_XML_FIELD and QS_XML_FIELD_OPT return
+   * in the attribute mode, created in the document toXml() is building so
+   * that it can be set on the class element. Null outside toXml(), where
+   * the getter returns the element form. */
+  QDomAttr xmlAttribute(const char* name, const QString& text) const {
+    QDomDocument* doc = xmlMemberDocument(name);
+    if (!doc) return QDomAttr();
+    QDomAttr attribute = doc->createAttribute(QString::fromLatin1(name));
+    attribute.setValue(text);
+    return attribute;
+  }
+
+  /*! \brief  A detached <name>text</name> element for a field that element
+   * holds as an attribute, for the setter to read; null when there is
+   * none. */
+  static QDomElement attributeElement(const QDomElement& element,
+                                      const QString& name) {
+    if (name.isEmpty() || !element.hasAttribute(name)) return QDomElement();
+    QDomDocument doc = element.ownerDocument();
+    QDomElement field = doc.createElement(name);
+    field.appendChild(doc.createTextNode(element.attribute(name)));
+    return field;
+  }
+
+ private:
+  template <typename T>
+  using IsPackable =
+      std::integral_constant<bool, std::is_arithmetic<T>::value &&
+                                       !std::is_same<T, bool>::value>;
+
+  template <typename Container>
+  static bool packXmlNumbers(QDomDocument&, QDomElement&, const Container&,
+                             XmlNumbers, std::false_type) {
+    return false;
+  }
+
+  template <typename Container>
+  static bool packXmlNumbers(QDomDocument& doc, QDomElement& element,
+                             const Container& numbers, XmlNumbers form,
+                             std::true_type) {
+    typedef typename Container::value_type T;
+    QByteArray text;
+    if (form == XmlNumberText) {
+      text.resize(int(numbers.size() * (kNumberBufferSize + 1)));
+      char* out = text.data();
+      for (const T& number : numbers) {
+        if (out != text.data()) *out++ = ' ';
+        out = formatNumber(out, number, std::is_floating_point<T>());
+      }
+      text.resize(int(out - text.data()));
+      element.setAttribute("packed", "text");
+    } else if (form == XmlNumberBase64) {
+      text = packLittleEndian(numbers).toBase64();
+      element.setAttribute("packed", "base64");
+    } else {
+      return false;
+    }
+    element.appendChild(doc.createTextNode(QString::fromLatin1(text)));
+    return true;
+  }
+
+  template <typename Container>
+  static bool unpackXmlNumbers(const QDomNode&, Container&, std::false_type) {
+    return false;
+  }
+
+  template <typename Container>
+  static bool unpackXmlNumbers(const QDomNode& node, Container& numbers,
+                               std::true_type) {
+    typedef typename Container::value_type T;
+    QDomElement element = node.toElement();
+    QString packed = element.attribute("packed");
+    if (packed.isEmpty()) return false;
+    QByteArray text = element.text().toLatin1();
+    if (packed == "base64") {
+      unpackLittleEndian(QByteArray::fromBase64(text), numbers);
+      return true;
+    }
+    const char* begin = text.constData();
+    const char* end = begin + text.size();
+    auto isSpace = [](char c) {
+      return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    };
+    std::size_t count = 0;
+    for (const char* p = begin; p != end; ++p) {
+      if (!isSpace(*p) && (p == begin || isSpace(p[-1]))) ++count;
+    }
+    count = limitCollection(count);
+    reserve(numbers, count);
+    const char* p = begin;
+    for (std::size_t i = 0; i < count; i++) {
+      while (isSpace(*p)) ++p;
+      const char* token = p;
+      while (p != end && !isSpace(*p)) ++p;
+      numbers.append(fromChars<T>(token, p));
+    }
+    return true;
+  }
+
+ public:
 #endif
 
 #ifdef QS_HAS_JSON
   /*! \brief  Serialize all accessed JSON properties for this object. */
   virtual QJsonObject toJson() const {
+    QS_PROFILE(ToJson);
     QJsonObject json;
+    ContextScope scope;
+    if (scope.depthExceeded()) return json;
+    const std::vector<Options>& propertyOptions =
+        scope.context()->propertyOptions(metaObject());
+    // compact size of the members, while a size report is made
+    qint64 sizeBytes = 0;
 
     for (int i = 0; i < metaObject()->propertyCount(); i++) {
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
@@ -239,13 +3044,16 @@ class QSerializer {
 #endif
 
       const char* propName = metaObject()->property(i).name();
+      QS_TRACE_FIELD(Json, Serialize, propName);
+      SizeScope sizeScope(scope.context(), propName);
       QJsonValue value =
           metaObject()->property(i).readOnGadget(this).toJsonValue();
 
       // Use member-level options
-      bool skipEmpty = shouldSkipMemberEmpty(propName);
-      bool skipNull = shouldSkipMemberNull(propName);
-      bool skipNullLiterals = shouldSkipMemberNullLiterals(propName);
+      const Options& options = propertyOptions[i];
+      const bool skipEmpty = options.skipEmpty;
+      const bool skipNull = options.skipNull;
+      const bool skipNullLiterals = options.skipNullLiterals;
 
       // skip empty values and nulls
       if ((skipEmpty && value.isString() && value.toString().isEmpty()) ||
@@ -258,19 +3066,78 @@ class QSerializer {
       }
 
       json.insert(propName, value);
+      QS_TRACE_BYTES(jsonSize(value));
+      if (sizeScope.active()) {
+        // "name":value
+        qint64 bytes =
+            qint64(std::strlen(propName)) + 3 + sizeScope.jsonSize(value);
+        sizeScope.add(bytes);
+        sizeBytes += bytes;
+      }
+    }
+    if (SizeScope* outer = scope.context()->m_sizeScope) {
+      // {} and the commas between the members
+      outer->addObject(sizeBytes + 2 + qMax<qint64>(json.size() - 1, 0), json);
     }
     return json;
   }
 
   /*! \brief  Returns QByteArray representation this object using
    * json-serialization. */
-  QByteArray toRawJson() const { return toByteArray(toJson()); }
+  QByteArray toRawJson() const {
+    QS_PROFILE_RAW(ToJson);
+    qint64& hint = sizeHint(metaObject()).json;
+    QByteArray data = toByteArray(toJson(), hint);
+    SizeHint::update(hint, data.size());
+    QS_PROFILE_BYTES(data.size());
+    return data;
+  }
+
+  /*! \brief  Serialize all accessed JSON properties for this object with the
+   * options and limits of ctx. */
+  QJsonObject toJson(SerializationContext& ctx) const {
+    ContextScope scope(&ctx);
+    return toJson();
+  }
+
+  /*! \brief  Returns QByteArray representation this object using
+   * json-serialization with the options and limits of ctx. */
+  QByteArray toRawJson(SerializationContext& ctx) const {
+    QS_PROFILE_RAW(ToJson);
+    qint64& hint = sizeHint(metaObject()).json;
+    QByteArray data = toByteArray(toJson(ctx), hint);
+    SizeHint::update(hint, data.size());
+    QS_PROFILE_BYTES(data.size());
+    return data;
+  }
+
+  /*! \brief  Serialize this object to compact JSON and attribute the bytes
+   * to its members, recursing into nested objects, collections of objects
+   * and dictionaries of objects. A diagnostic: the sizes come from one
+   * serialization, bottom-up. */
+  SizeNode jsonSizeReport() const {
+    SerializationContext ctx;
+    return jsonSizeReport(ctx);
+  }
+
+  /*! \brief  jsonSizeReport() with the options and limits of ctx. */
+  SizeNode jsonSizeReport(SerializationContext& ctx) const {
+    SizeNode root;
+    root.name = metaObject()->className();
+    root.count = 1;
+    SizeScope sizeScope(&ctx, root);
+    toJson(ctx);
+    root.bytes = sizeScope.nestedBytes();
+    return root;
+  }
 
   /*! \brief  Deserialize all accessed XML properties for this object. */
   virtual void fromJson(const QJsonValue& val) {
+    QS_PROFILE(FromJson);
     if (val.isObject()) {
+      ContextScope scope;
+      if (scope.depthExceeded()) return;
       QJsonObject json = val.toObject();
-      QStringList keys = json.keys();
       int propCount = metaObject()->propertyCount();
       for (int i = 0; i < propCount; i++) {
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
@@ -285,19 +3152,50 @@ class QSerializer {
         }
 #endif
 
-        for (auto key : json.keys()) {
-          if (key == metaObject()->property(i).name()) {
-            metaObject()->property(i).writeOnGadget(this, json.value(key));
-            break;
-          }
+        // direct lookup instead of scanning a copy of json.keys()
+        auto it =
+            json.constFind(QLatin1String(metaObject()->property(i).name()));
+        if (it != json.constEnd()) {
+          QS_TRACE_FIELD(Json, Deserialize, metaObject()->property(i).name());
+          QS_TRACE_BYTES(jsonSize(it.value()));
+          metaObject()->property(i).writeOnGadget(this, it.value());
         }
       }
     }
   }
 
+  /*! \brief  Deserialize all accessed JSON properties for this object using
+   * the scratch arena, options and limits of ctx. */
+  void fromJson(const QJsonValue& val, SerializationContext& ctx) {
+    ContextScope scope(&ctx);
+    fromJson(val);
+  }
+
   /*! \brief  Deserialize all accessed JSON properties for this object. */
   void fromJson(const QByteArray& data) {
-    fromJson(QJsonDocument::fromJson(data).object());
+    QS_PROFILE_RAW(FromJson);
+    QS_PROFILE_BYTES(data.size());
+    fromJson(parseJson(data).object());
+  }
+
+  /*! \brief  Deserialize all accessed JSON properties for this object from
+   * raw data the caller no longer needs; the buffer is freed right after
+   * parsing instead of living until the object is filled. */
+  void fromJson(QByteArray&& data) {
+    QS_PROFILE_RAW(FromJson);
+    QS_PROFILE_BYTES(data.size());
+    QJsonObject json = parseJson(data).object();
+    data = QByteArray();
+    fromJson(json);
+  }
+
+  /*! \brief  Deserialize all accessed JSON properties for this object using
+   * the scratch arena, options and limits of ctx. */
+  void fromJson(const QByteArray& data, SerializationContext& ctx) {
+    QS_PROFILE_RAW(FromJson);
+    QS_PROFILE_BYTES(data.size());
+    ContextScope scope(&ctx);
+    fromJson(parseJson(data).object());
   }
 
   /*! \brief  Create and deserialize an object of type T from JSON. */
@@ -316,13 +3214,31 @@ class QSerializer {
     obj.fromJson(data);
     return obj;
   }
+
+  /*! \brief  Create and deserialize an object of type T from a JSON byte
+   * array the caller no longer needs. */
+  template <typename T>
+  static T fromJson(QByteArray&& data) {
+    T obj;
+    obj.fromJson(std::move(data));
+    return obj;
+  }
 #endif  // QS_HAS_JSON
 
 #ifdef QS_HAS_XML
   /*! \brief  Serialize all accessed XML properties for this object. */
   virtual QDomNode toXml() const {
+    QS_PROFILE(ToXml);
     QDomDocument doc;
+    ContextScope scope;
+    if (scope.depthExceeded()) return doc;
+    const std::vector<Options>& propertyOptions =
+        scope.context()->propertyOptions(metaObject());
     QDomElement el = doc.createElement(metaObject()->className());
+    // size of the attributes and of the children, while a size report is
+    // made
+    qint64 sizeAttributes = 0;
+    qint64 sizeChildren = 0;
 
     for (int i = 0; i < metaObject()->propertyCount(); i++) {
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
@@ -336,14 +3252,21 @@ class QSerializer {
         continue;
       }
 #endif
-      const char* propName = metaObject()->property(i).name();
-      QDomNode nodeValue = QDomNode(
-          metaObject()->property(i).readOnGadget(this).value<QDomNode>());
-
+      QS_TRACE_FIELD(Xml, Serialize, metaObject()->property(i).name());
+      SizeScope sizeScope(scope.context(), metaObject()->property(i).name());
       // Use member-level options
-      bool skipEmpty = shouldSkipMemberEmpty(propName);
-      bool skipNull = shouldSkipMemberNull(propName);
-      bool skipNullLiterals = shouldSkipMemberNullLiterals(propName);
+      const Options& options = propertyOptions[i];
+      QDomNode nodeValue;
+      {
+        MemberScope memberScope(scope.context(), this,
+                                metaObject()->property(i).name(), &options,
+                                &doc);
+        nodeValue = QDomNode(
+            metaObject()->property(i).readOnGadget(this).value<QDomNode>());
+      }
+      const bool skipEmpty = options.skipEmpty;
+      const bool skipNull = options.skipNull;
+      const bool skipNullLiterals = options.skipNullLiterals;
 
       bool isNullLiteral = false;
       bool isEmpty = false;
@@ -352,6 +3275,12 @@ class QSerializer {
       if (nodeValue.isNull()) {
         isEmpty = true;
       }
+      // A single-value field in the attribute mode returns name="text"
+      else if (nodeValue.isAttr()) {
+        QString textValue = nodeValue.toAttr().value();
+        isNullLiteral = (textValue == "null");
+        isEmpty = textValue.isEmpty();
+      }
       // Then, check if it is a document node (QS_XML_FIELD returns a
       // QDomDocument)
       else if (nodeValue.isDocument()) {
@@ -383,49 +3312,148 @@ class QSerializer {
         continue;
       }
 
+      if (nodeValue.isAttr()) {
+        const QDomAttr attribute = nodeValue.toAttr();
+        QS_TRACE_BYTES(xmlAttributeSize(attribute));
+        if (sizeScope.active()) {
+          qint64 bytes = xmlAttributeSize(attribute);
+          sizeScope.add(bytes);
+          sizeAttributes += bytes;
+        }
+        el.setAttributeNode(attribute);
+        continue;
+      }
+      QS_TRACE_BYTES(xmlSize(nodeValue));
+      if (sizeScope.active()) {
+        qint64 bytes = sizeScope.xmlSize(nodeValue);
+        sizeScope.add(bytes);
+        sizeChildren += bytes;
+      }
       el.appendChild(nodeValue);
     }
     doc.appendChild(el);
+    if (SizeScope* outer = scope.context()->m_sizeScope) {
+      // <name attributes>children</name> or <name attributes/>
+      const qint64 name = qint64(std::strlen(metaObject()->className()));
+      qint64 bytes = 1 + name + sizeAttributes;
+      bytes += el.hasChildNodes() ? 1 + sizeChildren + 3 + name : 2;
+      outer->addObject(bytes, doc);
+    }
     return doc;
   }
 
   /*! \brief  Returns QByteArray representation this object using
    * xml-serialization. */
-  QByteArray toRawXml() const { return toByteArray(toXml()); }
+  QByteArray toRawXml() const {
+    QS_PROFILE_RAW(ToXml);
+    qint64& hint = sizeHint(metaObject()).xml;
+    QByteArray data = toByteArray(toXml(), hint);
+    SizeHint::update(hint, data.size());
+    QS_PROFILE_BYTES(data.size());
+    return data;
+  }
+
+  /*! \brief  Serialize all accessed XML properties for this object with the
+   * options and limits of ctx. */
+  QDomNode toXml(SerializationContext& ctx) const {
+    ContextScope scope(&ctx);
+    return toXml();
+  }
+
+  /*! \brief  Returns QByteArray representation this object using
+   * xml-serialization with the options and limits of ctx. */
+  QByteArray toRawXml(SerializationContext& ctx) const {
+    QS_PROFILE_RAW(ToXml);
+    qint64& hint = sizeHint(metaObject()).xml;
+    QByteArray data = toByteArray(toXml(ctx), hint);
+    SizeHint::update(hint, data.size());
+    QS_PROFILE_BYTES(data.size());
+    return data;
+  }
+
+  /*! \brief  Serialize this object to XML and attribute the bytes to its
+   * members like jsonSizeReport(). */
+  SizeNode xmlSizeReport() const {
+    SerializationContext ctx;
+    return xmlSizeReport(ctx);
+  }
+
+  /*! \brief  xmlSizeReport() with the options and limits of ctx. */
+  SizeNode xmlSizeReport(SerializationContext& ctx) const {
+    SizeNode root;
+    root.name = metaObject()->className();
+    root.count = 1;
+    SizeScope sizeScope(&ctx, root);
+    toXml(ctx);
+    root.bytes = sizeScope.nestedBytes();
+    return root;
+  }
 
   /*! \brief  Deserialize all accessed XML properties for this object. */
   virtual void fromXml(const QDomNode& val) {
+    QS_PROFILE(FromXml);
+    ContextScope scope;
+    if (scope.depthExceeded()) return;
     QDomNode doc = val;
     QDomElement rootElem = doc.firstChildElement(metaObject()->className());
+    // nested objects are handed their class element itself
+    QDomNode parent = rootElem.isNull() ? doc : QDomNode(rootElem);
 
-    if (!rootElem.isNull()) {
-      for (int i = 0; i < metaObject()->propertyCount(); i++) {
-        QDomElement tmp = metaObject()
-                             ->property(i)
-                             .readOnGadget(this)
-                             .value<QDomNode>()
-                             .firstChildElement();
-
-        auto f = rootElem.firstChildElement(tmp.tagName());
-        metaObject()->property(i).writeOnGadget(
-            this, QVariant::fromValue<QDomNode>(f));
+    for (int i = 0; i < metaObject()->propertyCount(); i++) {
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+      if (QString(metaObject()->property(i).typeName()) !=
+          QMetaType::typeName(qMetaTypeId<QDomNode>())) {
+        continue;
       }
-    } else {
-      for (int i = 0; i < metaObject()->propertyCount(); i++) {
-        auto f = doc.firstChildElement(metaObject()->property(i).name());
-        metaObject()->property(i).writeOnGadget(
-            this, QVariant::fromValue<QDomNode>(f));
+#else
+      if (metaObject()->property(i).metaType().id() !=
+          qMetaTypeId<QDomNode>()) {
+        continue;
       }
+#endif
+      const QString name =
+          QString::fromLatin1(metaObject()->property(i).name());
+      QDomNode current =
+          metaObject()->property(i).readOnGadget(this).value<QDomNode>();
+      // objects are written under their class name, attributes and
+      // everything else under the property name
+      QDomElement tmp = current.firstChildElement();
+      QDomElement f;
+      if (!tmp.isNull()) f = parent.firstChildElement(tmp.tagName());
+      if (f.isNull()) f = parent.firstChildElement(name);
+      if (f.isNull()) f = attributeElement(parent.toElement(), name);
+      QS_TRACE_FIELD(Xml, Deserialize, metaObject()->property(i).name());
+      QS_TRACE_BYTES(xmlSize(f));
+      metaObject()->property(i).writeOnGadget(
+          this, QVariant::fromValue<QDomNode>(f));
     }
   }
 
+  /*! \brief  Deserialize all accessed XML properties for this object using
+   * the scratch arena, options and limits of ctx. */
+  void fromXml(const QDomNode& val, SerializationContext& ctx) {
+    ContextScope scope(&ctx);
+    fromXml(val);
+  }
+
   /*! \brief  Deserialize all accessed XML properties for this object. */
   void fromXml(const QByteArray& data) {
+    QS_PROFILE_RAW(FromXml);
+    QS_PROFILE_BYTES(data.size());
     QDomDocument d;
     d.setContent(data);
     fromXml(d);
   }
 
+  /*! \brief  Deserialize all accessed XML properties for this object using
+   * the scratch arena, options and limits of ctx. */
+  void fromXml(const QByteArray& data, SerializationContext& ctx) {
+    QS_PROFILE_RAW(FromXml);
+    QS_PROFILE_BYTES(data.size());
+    ContextScope scope(&ctx);
+    fromXml(data);
+  }
+
   /*! \brief  Create and deserialize an object of type T from XML. */
   template <typename T>
   static T fromXml(const QDomNode& val) {
@@ -447,6 +3475,18 @@ class QSerializer {
 #define GET(prefix, name) get_##prefix##_##name
 #define SET(prefix, name) set_##prefix##_##name
 
+/* True for the XML members that hold a single value and may be written as
+ * attributes; the member attribute macros check it at compile time */
+#define QS_XML_VALUE(name) qs_xml_value_##name
+#ifdef QS_HAS_XML
+#define QS_CHECK_XML_VALUE(value)                                        \
+  static_assert(value,                                                   \
+                "XML attributes hold QS_XML_FIELD and QS_XML_FIELD_OPT " \
+                "members only")
+#else
+#define QS_CHECK_XML_VALUE(value) static_assert(true, "")
+#endif
+
 /* Create variable */
 #define QS_DECLARE_MEMBER(type, name) \
  public:                              \
@@ -462,11 +3502,10 @@ class QSerializer {
   Q_PROPERTY(QJsonValue name READ GET(json, name) WRITE SET(json, name)) \
  private:                                                                \
   QJsonValue GET(json, name)() const {                                   \
-    QJsonValue val = QJsonValue::fromVariant(QVariant(name));            \
-    return val;                                                          \
+    return QSerializer::toJsonValue(name);                               \
   }                                                                      \
   void SET(json, name)(const QJsonValue& varname) {                      \
-    name = varname.toVariant().value<type>();                            \
+    name = QSerializer::fromJsonValue<type>(varname);                    \
   }
 #define QS_JSON_FIELD_OPT(type, name)                                        \
   Q_PROPERTY(QJsonValue name READ GET(json, name) WRITE SET(json, name))     \
@@ -474,7 +3513,7 @@ class QSerializer {
   QJsonValue GET(json, name)() const {                                       \
     if (name.has_value()) {                                                  \
       /* When optional has a value, use QVariant for conversion */           \
-      return QJsonValue::fromVariant(QVariant(name.value()));                \
+      return QSerializer::toJsonValue(name.value());                         \
     } else {                                                                 \
       /* When optional is empty, return null; whether to write it depends on \
        * the skip null setting */                                            \
@@ -485,7 +3524,7 @@ class QSerializer {
     if (varname.isNull()) {                                                  \
       name = std::nullopt;                                                   \
     } else {                                                                 \
-      name = varname.toVariant().value<type>();                              \
+      name = QSerializer::fromJsonValue<type>(varname);                      \
     }                                                                        \
   }
 #define QS_JSON_OBJECT_OPT(type, name)                                   \
@@ -502,9 +3541,8 @@ class QSerializer {
     if (varname.isNull()) {                                              \
       name = std::nullopt;                                               \
     } else {                                                             \
-      type temp;                                                         \
-      temp.fromJson(varname);                                            \
-      name = temp;                                                       \
+      name.emplace();                                                    \
+      name->fromJson(varname);                                           \
     }                                                                    \
   }
 #else
@@ -515,64 +3553,86 @@ class QSerializer {
 
 /* Create XML property and methods for primitive type field*/
 #ifdef QS_HAS_XML
-#define QS_XML_FIELD(type, name)                                          \
-  Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name))      \
- private:                                                                 \
-  QDomNode GET(xml, name)() const {                                       \
-    QDomDocument doc;                                                     \
-    QString strname = #name;                                              \
-    QDomElement element = doc.createElement(strname);                     \
-    QDomText valueOfProp = doc.createTextNode(QVariant(name).toString()); \
-    element.appendChild(valueOfProp);                                     \
-    doc.appendChild(element);                                             \
-    return QDomNode(doc);                                                 \
-  }                                                                       \
-  void SET(xml, name)(const QDomNode& node) {                             \
-    if (!node.isNull() && node.isElement()) {                             \
-      QDomElement domElement = node.toElement();                          \
-      if (domElement.tagName() == #name)                                  \
-        name = QVariant(domElement.text()).value<type>();                 \
-    }                                                                     \
+#define QS_XML_FIELD(type, name)                                           \
+  Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name))       \
+ public:                                                                   \
+  enum { QS_XML_VALUE(name) = true };                                      \
+ private:                                                                  \
+  QDomNode GET(xml, name)() const {                                        \
+    if (memberOptions(#name).xmlAttribute) {                               \
+      QDomAttr attribute = xmlAttribute(#name, QSerializer::toText(name)); \
+      if (!attribute.isNull()) return attribute;                           \
+    }                                                                      \
+    QDomDocument doc;                                                      \
+    QString strname = #name;                                               \
+    QDomElement element = doc.createElement(strname);                      \
+    QDomText valueOfProp = doc.createTextNode(QSerializer::toText(name));  \
+    element.appendChild(valueOfProp);                                      \
+    doc.appendChild(element);                                              \
+    return QDomNode(doc);                                                  \
+  }                                                                        \
+  void SET(xml, name)(const QDomNode& node) {                              \
+    if (!node.isNull() && node.isElement()) {                              \
+      QDomElement domElement = node.toElement();                           \
+      if (domElement.tagName() == #name)                                   \
+        name = QSerializer::fromText<type>(domElement.text());             \
+    }                                                                      \
   }
-#define QS_XML_FIELD_OPT(type, name)                                      \
-  Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name))      \
- private:                                                                 \
-  QDomNode GET(xml, name)() const {                                       \
-    QDomDocument doc;                                                     \
-    QString strname = #name;                                              \
-    QDomElement element = doc.createElement(strname);                     \
-    if (name.has_value()) {                                               \
-      QDomText valueOfProp =                                              \
-          doc.createTextNode(QVariant(name.value()).toString());          \
-      element.appendChild(valueOfProp);                                   \
-    } else {                                                              \
+#define QS_XML_FIELD_OPT(type, name)                                  \
+  Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name))  \
+ public:                                                              \
+  enum { QS_XML_VALUE(name) = true };                                 \
+ private:                                                             \
+  QDomNode GET(xml, name)() const {                                   \
+    if (memberOptions(#name).xmlAttribute) {                          \
+      QDomAttr attribute = xmlAttribute(                              \
+          #name, name.has_value() ? QSerializer::toText(name.value()) \
+                                  : QString("null"));                 \
+      if (!attribute.isNull()) return attribute;                      \
+    }                                                                 \
+    QDomDocument doc;                                                 \
+    QString strname = #name;                                          \
+    QDomElement element = doc.createElement(strname);                 \
+    if (name.has_value()) {                                           \
+      QDomText valueOfProp =                                          \
+          doc.createTextNode(QSerializer::toText(name.value()));      \
+      element.appendChild(valueOfProp);                               \
+    } else {                                                          \
       /* Generate “null” text when optional field is null, subsequent \
-       * deserialization identifies as null */                            \
-      QDomText valueOfProp = doc.createTextNode("null");                  \
-      element.appendChild(valueOfProp);                                   \
-    }                                                                     \
-    doc.appendChild(element);                                             \
-    return QDomNode(doc);                                                 \
-  }                                                                       \
-  void SET(xml, name)(const QDomNode& node) {                             \
-    if (!node.isNull() && node.isElement()) {                             \
-      QDomElement domElement = node.toElement();                          \
-      if (domElement.tagName() == #name) {                                \
-        QString text = domElement.text();                                 \
-        if (text == "null") {                                             \
-          name = std::nullopt;                                            \
-        } else {                                                          \
-          name = QVariant(text).value<type>();                            \
-        }                                                                 \
-      }                                                                   \
-    }                                                                     \
+       * deserialization identifies as null */                        \
+      QDomText valueOfProp = doc.createTextNode("null");              \
+      element.appendChild(valueOfProp);                               \
+    }                                                                 \
+    doc.appendChild(element);                                         \
+    return QDomNode(doc);                                             \
+  }                                                                   \
+  void SET(xml, name)(const QDomNode& node) {                         \
+    if (!node.isNull() && node.isElement()) {                         \
+      QDomElement domElement = node.toElement();                      \
+      if (domElement.tagName() == #name) {                            \
+        QString text = domElement.text();                             \
+        if (text == "null") {                                         \
+          name = std::nullopt;                                        \
+        } else {                                                      \
+          name = QSerializer::fromText<type>(text);                   \
+        }                                                             \
+      }                                                               \
+    }                                                                 \
   }
 #define QS_XML_OBJECT_OPT(type, name)                                \
   Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name)) \
+ public:                                                             \
+  enum { QS_XML_VALUE(name) = false };                               \
  private:                                                            \
   QDomNode GET(xml, name)() const {                                  \
     if (name.has_value()) {                                          \
       return name.value().toXml();                                   \
+    } else if (!xmlMemberDocument(#name)) {                          \
+      /* fromXml() looks the value up under this tag */              \
+      QDomDocument doc;                                              \
+      doc.appendChild(                                               \
+          doc.createElement(type::staticMetaObject.className()));    \
+      return QDomNode(doc);                                          \
     } else {                                                         \
       QDomDocument doc;                                              \
       QDomElement element = doc.createElement(#name);                \
@@ -587,9 +3647,8 @@ class QSerializer {
       if (domElement.text() == "null") {                             \
         name = std::nullopt;                                         \
       } else {                                                       \
-        type temp;                                                   \
-        temp.fromXml(node);                                          \
-        name = temp;                                                 \
+        name.emplace();                                              \
+        name->fromXml(node);                                         \
       }                                                              \
     }                                                                \
   }
@@ -608,17 +3667,21 @@ class QSerializer {
  private:                                                                \
   QJsonValue GET(json, name)() const {                                   \
     QJsonArray val;                                                      \
-    for (int i = 0; i < name.size(); i++) val.push_back(name.at(i));     \
-    return QJsonValue::fromVariant(val);                                 \
+    for (int i = 0; i < name.size(); i++)                                \
+      val.push_back(QSerializer::toJsonValue(name.at(i)));               \
+    return QJsonValue(std::move(val));                                   \
   }                                                                      \
   void SET(json, name)(const QJsonValue& varname) {                      \
     if (!varname.isArray()) return;                                      \
-    name.clear();                                                        \
     QJsonArray val = varname.toArray();                                  \
-    for (int i = 0; i < val.size(); i++) {                               \
-      itemType tmp;                                                      \
-      tmp = val.at(i).toVariant().value<itemType>();                     \
-      name.append(tmp);                                                  \
+    int n = QSerializer::limitCollection(val.size());                    \
+    int kept = QSerializer::prepareCollection(name, n);                  \
+    QSerializer::reserve(name, n);                                       \
+    for (int i = 0; i < kept; i++) {                                     \
+      name[i] = QSerializer::fromJsonValue<itemType>(val.at(i));         \
+    }                                                                    \
+    for (int i = kept; i < n; i++) {                                     \
+      name.append(QSerializer::fromJsonValue<itemType>(val.at(i)));      \
     }                                                                    \
   }
 #else
@@ -631,19 +3694,29 @@ class QSerializer {
 #ifdef QS_HAS_XML
 #define QS_XML_ARRAY(itemType, name)                                      \
   Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name))      \
+ public:                                                                  \
+  enum { QS_XML_VALUE(name) = false };                                    \
  private:                                                                 \
   QDomNode GET(xml, name)() const {                                       \
     QDomDocument doc;                                                     \
     QString strname = #name;                                              \
+    QSerializer::Options options = memberOptions(#name);                  \
     QDomElement arrayXml = doc.createElement(QString(strname));           \
-    arrayXml.setAttribute("type", "array");                               \
+    if (!options.compactXml) arrayXml.setAttribute("type", "array");      \
+    if (QSerializer::packXmlNumbers(doc, arrayXml, name,                  \
+                                    options.xmlNumbers)) {                \
+      doc.appendChild(arrayXml);                                          \
+      return QDomNode(doc);                                               \
+    }                                                                     \
                                                                           \
     for (int i = 0; i < name.size(); i++) {                               \
       itemType item = name.at(i);                                         \
       QDomElement itemXml = doc.createElement("item");                    \
-      itemXml.setAttribute("type", #itemType);                            \
-      itemXml.setAttribute("index", i);                                   \
-      itemXml.appendChild(doc.createTextNode(QVariant(item).toString())); \
+      if (!options.compactXml) {                                          \
+        itemXml.setAttribute("type", #itemType);                          \
+        itemXml.setAttribute("index", i);                                 \
+      }                                                                   \
+      itemXml.appendChild(doc.createTextNode(QSerializer::toText(item))); \
       arrayXml.appendChild(itemXml);                                      \
     }                                                                     \
                                                                           \
@@ -651,14 +3724,17 @@ class QSerializer {
     return QDomNode(doc);                                                 \
   }                                                                       \
   void SET(xml, name)(const QDomNode& node) {                             \
-    QDomNode domNode = node.firstChild();                                 \
-    name.clear();                                                         \
-    while (!domNode.isNull()) {                                           \
-      if (domNode.isElement()) {                                          \
-        QDomElement domElement = domNode.toElement();                     \
-        name.append(QVariant(domElement.text()).value<itemType>());       \
-      }                                                                   \
-      domNode = domNode.nextSibling();                                    \
+    auto nodesList = QSerializer::childElements(node);                    \
+    int n =                                                               \
+        QSerializer::limitCollection(static_cast<int>(nodesList.size())); \
+    int kept = QSerializer::prepareCollection(name, n);                   \
+    if (kept == 0 && QSerializer::unpackXmlNumbers(node, name)) return;   \
+    QSerializer::reserve(name, n);                                        \
+    for (int i = 0; i < kept; i++) {                                      \
+      name[i] = QSerializer::fromText<itemType>(nodesList[i].text());     \
+    }                                                                     \
+    for (int i = kept; i < n; i++) {                                      \
+      name.append(QSerializer::fromText<itemType>(nodesList[i].text()));  \
     }                                                                     \
   }
 #else
@@ -690,6 +3766,8 @@ class QSerializer {
 #ifdef QS_HAS_XML
 #define QS_XML_OBJECT(type, name)                                    \
   Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name)) \
+ public:                                                             \
+  enum { QS_XML_VALUE(name) = false };                               \
  private:                                                            \
   QDomNode GET(xml, name)() const { return name.toXml(); }           \
   void SET(xml, name)(const QDomNode& node) { name.fromXml(node); }
@@ -709,16 +3787,18 @@ class QSerializer {
   QJsonValue GET(json, name)() const {                                        \
     QJsonArray val;                                                           \
     for (int i = 0; i < name.size(); i++) val.push_back(name.at(i).toJson()); \
-    return QJsonValue::fromVariant(val);                                      \
+    return QJsonValue(std::move(val));                                        \
   }                                                                           \
   void SET(json, name)(const QJsonValue& varname) {                           \
     if (!varname.isArray()) return;                                           \
-    name.clear();                                                             \
     QJsonArray val = varname.toArray();                                       \
-    for (int i = 0; i < val.size(); i++) {                                    \
-      itemType tmp;                                                           \
-      tmp.fromJson(val.at(i));                                                \
-      name.append(tmp);                                                       \
+    int n = QSerializer::limitCollection(val.size());                         \
+    int kept = QSerializer::prepareCollection(name, n);                       \
+    QSerializer::reserve(name, n);                                            \
+    for (int i = 0; i < kept; i++) name[i].fromJson(val.at(i));               \
+    for (int i = kept; i < n; i++) {                                          \
+      name.append(itemType());                                                \
+      name.last().fromJson(val.at(i));                                        \
     }                                                                         \
   }
 #else
@@ -733,23 +3813,29 @@ class QSerializer {
 #ifdef QS_HAS_XML
 #define QS_XML_ARRAY_OBJECTS(itemType, name)                         \
   Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name)) \
+ public:                                                             \
+  enum { QS_XML_VALUE(name) = false };                               \
  private:                                                            \
   QDomNode GET(xml, name)() const {                                  \
     QDomDocument doc;                                                \
     QDomElement element = doc.createElement(#name);                  \
-    element.setAttribute("type", "array");                           \
+    if (!memberOptions(#name).compactXml) {                          \
+      element.setAttribute("type", "array");                         \
+    }                                                                \
     for (int i = 0; i < name.size(); i++)                            \
       element.appendChild(name.at(i).toXml());                       \
     doc.appendChild(element);                                        \
     return QDomNode(doc);                                            \
   }                                                                  \
   void SET(xml, name)(const QDomNode& node) {                        \
-    name.clear();                                                    \
-    QDomNodeList nodesList = node.childNodes();                      \
-    for (int i = 0; i < nodesList.size(); i++) {                     \
-      itemType tmp;                                                  \
-      tmp.fromXml(nodesList.at(i));                                  \
-      name.append(tmp);                                              \
+    auto nodesList = QSerializer::childElements(node);               \
+    std::size_t n = QSerializer::limitCollection(nodesList.size());  \
+    int kept = QSerializer::prepareCollection(name, n);              \
+    QSerializer::reserve(name, n);                                   \
+    for (int i = 0; i < kept; i++) name[i].fromXml(nodesList[i]);    \
+    for (std::size_t i = kept; i < n; i++) {                         \
+      name.append(itemType());                                       \
+      name.last().fromXml(nodesList[i]);                             \
     }                                                                \
   }
 #else
@@ -770,17 +3856,28 @@ class QSerializer {
   QJsonValue GET(json, name)() const {                                   \
     QJsonObject val;                                                     \
     for (auto p = name.constBegin(); p != name.constEnd(); ++p) {        \
-      val.insert(QVariant(p.key()).toString(),                           \
-                 QJsonValue::fromVariant(QVariant(p.value())));          \
+      val.insert(QSerializer::toText(p.key()),                           \
+                 QSerializer::toJsonValue(p.value()));                   \
     }                                                                    \
     return val;                                                          \
   }                                                                      \
   void SET(json, name)(const QJsonValue& varname) {                      \
     QJsonObject val = varname.toObject();                                \
-    name.clear();                                                        \
+    if (QSerializer::reuseElements()) {                                  \
+      for (auto p = name.begin(); p != name.end();) {                    \
+        if (val.contains(QSerializer::toText(p.key())))                  \
+          ++p;                                                           \
+        else                                                             \
+          p = name.erase(p);                                             \
+      }                                                                  \
+    } else {                                                             \
+      name.clear();                                                      \
+    }                                                                    \
+    QSerializer::reserve(name, val.size());                              \
     for (auto p = val.constBegin(); p != val.constEnd(); ++p) {          \
-      name.insert(QVariant(p.key()).value<map::key_type>(),              \
-                  QVariant(p.value()).value<map::mapped_type>());        \
+      name.insert(                                                       \
+          QSerializer::fromText<map::key_type>(p.key()),                 \
+          QSerializer::fromJsonValue<map::mapped_type>(p.value()));      \
     }                                                                    \
   }
 #else
@@ -797,15 +3894,19 @@ class QSerializer {
 #ifdef QS_HAS_XML
 #define QS_XML_QT_DICT(map, name)                                    \
   Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name)) \
+ public:                                                             \
+  enum { QS_XML_VALUE(name) = false };                               \
  private:                                                            \
   QDomNode GET(xml, name)() const {                                  \
     QDomDocument doc;                                                \
     QDomElement element = doc.createElement(#name);                  \
-    element.setAttribute("type", "map");                             \
+    if (!memberOptions(#name).compactXml) {                          \
+      element.setAttribute("type", "map");                           \
+    }                                                                \
     for (auto p = name.begin(); p != name.end(); ++p) {              \
       QDomElement e = doc.createElement("item");                     \
-      e.setAttribute("key", QVariant(p.key()).toString());           \
-      e.setAttribute("value", QVariant(p.value()).toString());       \
+      e.setAttribute("key", QSerializer::toText(p.key()));           \
+      e.setAttribute("value", QSerializer::toText(p.value()));       \
       element.appendChild(e);                                        \
     }                                                                \
     doc.appendChild(element);                                        \
@@ -815,14 +3916,15 @@ class QSerializer {
     if (!node.isNull() && node.isElement()) {                        \
       QDomElement root = node.toElement();                           \
       if (root.tagName() == #name) {                                 \
-        QDomNodeList childs = root.childNodes();                     \
-                                                                     \
-        for (int i = 0; i < childs.size(); ++i) {                    \
-          QDomElement item = childs.at(i).toElement();               \
-          name.insert(QVariant(item.attributeNode("key").value())    \
-                          .value<map::key_type>(),                   \
-                      QVariant(item.attributeNode("value").value())  \
-                          .value<map::mapped_type>());               \
+        auto nodesList = QSerializer::childElements(root);           \
+        if (QSerializer::reuseElements())                            \
+          QSerializer::eraseMissingKeys(name, nodesList);            \
+        QSerializer::reserve(name, name.size() + nodesList.size());  \
+        for (const QDomElement& item : nodesList) {                  \
+          name.insert(QSerializer::fromText<map::key_type>(          \
+                          item.attribute("key")),                    \
+                      QSerializer::fromText<map::mapped_type>(       \
+                          item.attribute("value")));                 \
         }                                                            \
       }                                                              \
     }                                                                \
@@ -838,24 +3940,36 @@ class QSerializer {
 /* THIS IS FOR QT DICTIONARY TYPES, for example QMap<int,
  * CustomSerializableType> */
 #ifdef QS_HAS_JSON
-#define QS_JSON_QT_DICT_OBJECTS(map, name)                                     \
-  Q_PROPERTY(QJsonValue name READ GET(json, name) WRITE SET(json, name))       \
- private:                                                                      \
-  QJsonValue GET(json, name)() const {                                         \
-    QJsonObject val;                                                           \
-    for (auto p = name.begin(); p != name.end(); ++p) {                        \
-      val.insert(QVariant::fromValue(p.key()).toString(), p.value().toJson()); \
-    }                                                                          \
-    return val;                                                                \
-  }                                                                            \
-  void SET(json, name)(const QJsonValue& varname) {                            \
-    QJsonObject val = varname.toObject();                                      \
-    name.clear();                                                              \
-    for (auto p = val.constBegin(); p != val.constEnd(); ++p) {                \
-      map::mapped_type tmp;                                                    \
-      tmp.fromJson(p.value());                                                 \
-      name.insert(QVariant(p.key()).value<map::key_type>(), tmp);              \
-    }                                                                          \
+#define QS_JSON_QT_DICT_OBJECTS(map, name)                               \
+  Q_PROPERTY(QJsonValue name READ GET(json, name) WRITE SET(json, name)) \
+ private:                                                                \
+  QJsonValue GET(json, name)() const {                                   \
+    QJsonObject val;                                                     \
+    for (auto p = name.begin(); p != name.end(); ++p) {                  \
+      val.insert(QSerializer::toText(p.key()), p.value().toJson());      \
+    }                                                                    \
+    return val;                                                          \
+  }                                                                      \
+  void SET(json, name)(const QJsonValue& varname) {                      \
+    QJsonObject val = varname.toObject();                                \
+    bool reuse = QSerializer::reuseElements();                           \
+    if (reuse) {                                                         \
+      for (auto p = name.begin(); p != name.end();) {                    \
+        if (val.contains(QSerializer::toText(p.key())))                  \
+          ++p;                                                           \
+        else                                                             \
+          p = name.erase(p);                                             \
+      }                                                                  \
+    } else {                                                             \
+      name.clear();                                                      \
+    }                                                                    \
+    QSerializer::reserve(name, val.size());                              \
+    for (auto p = val.constBegin(); p != val.constEnd(); ++p) {          \
+      map::key_type key = QSerializer::fromText<map::key_type>(p.key()); \
+      auto it = reuse ? name.find(key) : name.end();                     \
+      if (it == name.end()) it = name.insert(key, map::mapped_type());   \
+      it.value().fromJson(p.value());                                    \
+    }                                                                    \
   }
 #else
 #define QS_JSON_QT_DICT_OBJECTS(map, name)
@@ -870,14 +3984,18 @@ class QSerializer {
 #ifdef QS_HAS_XML
 #define QS_XML_QT_DICT_OBJECTS(map, name)                            \
   Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name)) \
+ public:                                                             \
+  enum { QS_XML_VALUE(name) = false };                               \
  private:                                                            \
   QDomNode GET(xml, name)() const {                                  \
     QDomDocument doc;                                                \
     QDomElement element = doc.createElement(#name);                  \
-    element.setAttribute("type", "map");                             \
+    if (!memberOptions(#name).compactXml) {                          \
+      element.setAttribute("type", "map");                           \
+    }                                                                \
     for (auto p = name.begin(); p != name.end(); ++p) {              \
       QDomElement e = doc.createElement("item");                     \
-      e.setAttribute("key", QVariant(p.key()).toString());           \
+      e.setAttribute("key", QSerializer::toText(p.key()));           \
       e.appendChild(p.value().toXml());                              \
       element.appendChild(e);                                        \
     }                                                                \
@@ -888,15 +4006,18 @@ class QSerializer {
     if (!node.isNull() && node.isElement()) {                        \
       QDomElement root = node.toElement();                           \
       if (root.tagName() == #name) {                                 \
-        QDomNodeList childs = root.childNodes();                     \
-                                                                     \
-        for (int i = 0; i < childs.size(); ++i) {                    \
-          QDomElement item = childs.at(i).toElement();               \
-          map::mapped_type tmp;                                      \
-          tmp.fromXml(item.firstChild());                            \
-          name.insert(QVariant(item.attributeNode("key").value())    \
-                          .value<map::key_type>(),                   \
-                      tmp);                                          \
+        auto nodesList = QSerializer::childElements(root);           \
+        bool reuse = QSerializer::reuseElements();                   \
+        if (reuse) QSerializer::eraseMissingKeys(name, nodesList);   \
+        QSerializer::reserve(name, name.size() + nodesList.size());  \
+        for (const QDomElement& item : nodesList) {                  \
+          map::key_type key = QSerializer::fromText<map::key_type>(  \
+              item.attribute("key"));                                \
+          auto it = reuse ? name.find(key) : name.end();             \
+          if (it == name.end()) {                                    \
+            it = name.insert(key, map::mapped_type());               \
+          }                                                          \
+          it.value().fromXml(item.firstChild());                     \
         }                                                            \
       }                                                              \
     }                                                                \
@@ -919,18 +4040,27 @@ class QSerializer {
   QJsonValue GET(json, name)() const {                                   \
     QJsonObject val;                                                     \
     for (const auto& p : name) {                                         \
-      val.insert(QVariant::fromValue(p.first).toString(),                \
-                 QJsonValue::fromVariant(QVariant(p.second)));           \
+      val.insert(QSerializer::toText(p.first),                           \
+                 QSerializer::toJsonValue(p.second));                    \
     }                                                                    \
     return val;                                                          \
   }                                                                      \
   void SET(json, name)(const QJsonValue& varname) {                      \
     QJsonObject val = varname.toObject();                                \
-    name.clear();                                                        \
+    if (QSerializer::reuseElements()) {                                  \
+      for (auto p = name.begin(); p != name.end();) {                    \
+        if (val.contains(QSerializer::toText(p->first)))                 \
+          ++p;                                                           \
+        else                                                             \
+          p = name.erase(p);                                             \
+      }                                                                  \
+    } else {                                                             \
+      name.clear();                                                      \
+    }                                                                    \
+    QSerializer::reserve(name, val.size());                              \
     for (auto p = val.constBegin(); p != val.constEnd(); ++p) {          \
-      name.insert(std::pair<map::key_type, map::mapped_type>(            \
-          QVariant(p.key()).value<map::key_type>(),                      \
-          QVariant(p.value()).value<map::mapped_type>()));               \
+      name[QSerializer::fromText<map::key_type>(p.key())] =              \
+          QSerializer::fromJsonValue<map::mapped_type>(p.value());       \
     }                                                                    \
   }
 #else
@@ -940,15 +4070,19 @@ class QSerializer {
 #ifdef QS_HAS_XML
 #define QS_XML_STL_DICT(map, name)                                   \
   Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name)) \
+ public:                                                             \
+  enum { QS_XML_VALUE(name) = false };                               \
  private:                                                            \
   QDomNode GET(xml, name)() const {                                  \
     QDomDocument doc;                                                \
     QDomElement element = doc.createElement(#name);                  \
-    element.setAttribute("type", "map");                             \
+    if (!memberOptions(#name).compactXml) {                          \
+      element.setAttribute("type", "map");                           \
+    }                                                                \
     for (const auto& p : name) {                                     \
       QDomElement e = doc.createElement("item");                     \
-      e.setAttribute("key", QVariant(p.first).toString());           \
-      e.setAttribute("value", QVariant(p.second).toString());        \
+      e.setAttribute("key", QSerializer::toText(p.first));           \
+      e.setAttribute("value", QSerializer::toText(p.second));        \
       element.appendChild(e);                                        \
     }                                                                \
     doc.appendChild(element);                                        \
@@ -958,15 +4092,15 @@ class QSerializer {
     if (!node.isNull() && node.isElement()) {                        \
       QDomElement root = node.toElement();                           \
       if (root.tagName() == #name) {                                 \
-        QDomNodeList childs = root.childNodes();                     \
-                                                                     \
-        for (int i = 0; i < childs.size(); ++i) {                    \
-          QDomElement item = childs.at(i).toElement();               \
-          name.insert(std::pair<map::key_type, map::mapped_type>(    \
-              QVariant(item.attributeNode("key").value())            \
-                  .value<map::key_type>(),                           \
-              QVariant(item.attributeNode("value").value())          \
-                  .value<map::mapped_type>()));                      \
+        auto nodesList = QSerializer::childElements(root);           \
+        if (QSerializer::reuseElements())                            \
+          QSerializer::eraseMissingKeys(name, nodesList);            \
+        QSerializer::reserve(name, name.size() + nodesList.size());  \
+        for (const QDomElement& item : nodesList) {                  \
+          name[QSerializer::fromText<map::key_type>(                 \
+              item.attribute("key"))] =                              \
+              QSerializer::fromText<map::mapped_type>(               \
+                  item.attribute("value"));                          \
         }                                                            \
       }                                                              \
     }                                                                \
@@ -982,25 +4116,41 @@ class QSerializer {
 /* THIS IS FOR STL DICTIONARY TYPES, for example std::map<int,
  * CustomSerializableType> */
 #ifdef QS_HAS_JSON
-#define QS_JSON_STL_DICT_OBJECTS(map, name)                                   \
-  Q_PROPERTY(QJsonValue name READ GET(json, name) WRITE SET(json, name))      \
- private:                                                                     \
-  QJsonValue GET(json, name)() const {                                        \
-    QJsonObject val;                                                          \
-    for (const auto& p : name) {                                              \
-      val.insert(QVariant::fromValue(p.first).toString(), p.second.toJson()); \
-    }                                                                         \
-    return val;                                                               \
-  }                                                                           \
-  void SET(json, name)(const QJsonValue& varname) {                           \
-    QJsonObject val = varname.toObject();                                     \
-    name.clear();                                                             \
-    for (auto p = val.constBegin(); p != val.constEnd(); ++p) {               \
-      map::mapped_type tmp;                                                   \
-      tmp.fromJson(p.value());                                                \
-      name.insert(std::pair<map::key_type, map::mapped_type>(                 \
-          QVariant(p.key()).value<map::key_type>(), tmp));                    \
-    }                                                                         \
+#define QS_JSON_STL_DICT_OBJECTS(map, name)                              \
+  Q_PROPERTY(QJsonValue name READ GET(json, name) WRITE SET(json, name)) \
+ private:                                                                \
+  QJsonValue GET(json, name)() const {                                   \
+    QJsonObject val;                                                     \
+    for (const auto& p : name) {                                         \
+      val.insert(QSerializer::toText(p.first), p.second.toJson());       \
+    }                                                                    \
+    return val;                                                          \
+  }                                                                      \
+  void SET(json, name)(const QJsonValue& varname) {                      \
+    QJsonObject val = varname.toObject();                                \
+    bool reuse = QSerializer::reuseElements();                           \
+    if (reuse) {                                                         \
+      for (auto p = name.begin(); p != name.end();) {                    \
+        if (val.contains(QSerializer::toText(p->first)))                 \
+          ++p;                                                           \
+        else                                                             \
+          p = name.erase(p);                                             \
+      }                                                                  \
+    } else {                                                             \
+      name.clear();                                                      \
+    }                                                                    \
+    QSerializer::reserve(name, val.size());                              \
+    for (auto p = val.constBegin(); p != val.constEnd(); ++p) {          \
+      map::key_type key = QSerializer::fromText<map::key_type>(p.key()); \
+      auto it = reuse ? name.find(key) : name.end();                     \
+      if (it == name.end()) {                                            \
+        it = name.emplace(std::piecewise_construct,                      \
+                          std::forward_as_tuple(std::move(key)),         \
+                          std::forward_as_tuple())                       \
+                 .first;                                                 \
+      }                                                                  \
+      it->second.fromJson(p.value());                                    \
+    }                                                                    \
   }
 #else
 #define QS_JSON_STL_DICT_OBJECTS(map, name)
@@ -1015,14 +4165,18 @@ class QSerializer {
 #ifdef QS_HAS_XML
 #define QS_XML_STL_DICT_OBJECTS(map, name)                           \
   Q_PROPERTY(QDomNode name READ GET(xml, name) WRITE SET(xml, name)) \
+ public:                                                             \
+  enum { QS_XML_VALUE(name) = false };                               \
  private:                                                            \
   QDomNode GET(xml, name)() const {                                  \
     QDomDocument doc;                                                \
     QDomElement element = doc.createElement(#name);                  \
-    element.setAttribute("type", "map");                             \
+    if (!memberOptions(#name).compactXml) {                          \
+      element.setAttribute("type", "map");                           \
+    }                                                                \
     for (const auto& p : name) {                                     \
       QDomElement e = doc.createElement("item");                     \
-      e.setAttribute("key", QVariant(p.first).toString());           \
+      e.setAttribute("key", QSerializer::toText(p.first));           \
       e.appendChild(p.second.toXml());                               \
       element.appendChild(e);                                        \
     }                                                                \
@@ -1033,16 +4187,23 @@ class QSerializer {
     if (!node.isNull() && node.isElement()) {                        \
       QDomElement root = node.toElement();                           \
       if (root.tagName() == #name) {                                 \
-        QDomNodeList childs = root.childNodes();                     \
-                                                                     \
-        for (int i = 0; i < childs.size(); ++i) {                    \
-          QDomElement item = childs.at(i).toElement();               \
-          map::mapped_type tmp;                                      \
-          tmp.fromXml(item.firstChild());                            \
-          name.insert(std::pair<map::key_type, map::mapped_type>(    \
-              QVariant(item.attributeNode("key").value())            \
-                  .value<map::key_type>(),                           \
-              tmp));                                                 \
+        auto nodesList = QSerializer::childElements(root);           \
+        bool reuse = QSerializer::reuseElements();                   \
+        if (reuse) QSerializer::eraseMissingKeys(name, nodesList);   \
+        QSerializer::reserve(name, name.size() + nodesList.size());  \
+        for (const QDomElement& item : nodesList) {                  \
+          map::key_type key = QSerializer::fromText<map::key_type>(  \
+              item.attribute("key"));                                \
+          auto it = name.find(key);                                  \
+          if (it == name.end()) {                                    \
+            it = name.emplace(std::piecewise_construct,              \
+                              std::forward_as_tuple(std::move(key)), \
+                              std::forward_as_tuple())               \
+                     .first;                                         \
+          } else if (!reuse) {                                       \
+            continue;                                                \
+          }                                                          \
+          it->second.fromXml(item.firstChild());                     \
         }                                                            \
       }                                                              \
     }                                                                \
@@ -1209,7 +4370,7 @@ class QSerializer {
       opts.skipEmpty = skipEmpty;                                              \
       opts.skipNull = skipNull;                                                \
       opts.skipNullLiterals = skipNullLiterals;                                \
-      QSerializer::setClassOptions(#className, opts);                          \
+      QSerializer::setClassSkipOptions(#className, opts);                      \
     }                                                                          \
   };                                                                           \
   static className##_options_initializer className##_options_init;             \
@@ -1227,6 +4388,43 @@ class QSerializer {
 #define QS_SKIP_EMPTY_AND_NULL_LITERALS(className) \
   QS_SERIALIZE_OPTIONS(className, true, true, true)
 
+/* XML form of the QS_XML_ARRAY collections of numbers of a class: Items
+ * (the default), Text or Base64; see QSerializer::XmlNumbers */
+#define QS_XML_NUMBERS(className, form)                               \
+  namespace {                                                         \
+  struct className##_xml_numbers_initializer {                        \
+    className##_xml_numbers_initializer() {                           \
+      QSerializer::setClassXmlNumbers(#className,                     \
+                                      QSerializer::XmlNumber##form);  \
+    }                                                                 \
+  };                                                                  \
+  static className##_xml_numbers_initializer className##_xml_numbers; \
+  }
+
+/* Compact XML arrays and dictionaries of a class, without the type and
+ * index attributes */
+#define QS_COMPACT_XML(className)                                     \
+  namespace {                                                         \
+  struct className##_compact_xml_initializer {                        \
+    className##_compact_xml_initializer() {                           \
+      QSerializer::setClassCompactXml(#className, true);              \
+    }                                                                 \
+  };                                                                  \
+  static className##_compact_xml_initializer className##_compact_xml; \
+  }
+
+/* Single-value fields of a class written as XML attributes of the class
+ * element */
+#define QS_XML_ATTRIBUTES(className)                                        \
+  namespace {                                                               \
+  struct className##_xml_attributes_initializer {                           \
+    className##_xml_attributes_initializer() {                              \
+      QSerializer::setClassXmlAttributes(#className, true);                 \
+    }                                                                       \
+  };                                                                        \
+  static className##_xml_attributes_initializer className##_xml_attributes; \
+  }
+
 #if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
 #define QS_INTERNAL_SERIALIZE_OPTIONS(skipEmpty, skipNull, skipNullLiterals)  \
  private:                                                                     \
@@ -1235,8 +4433,8 @@ class QSerializer {
   class OptionsInitializer {                                                  \
    public:                                                                    \
     OptionsInitializer() {                                                    \
-      QSerializer::setClassOptions(staticMetaObject.className(),              \
-                                   _classOptions);                            \
+      QSerializer::setClassSkipOptions(staticMetaObject.className(),          \
+                                       _classOptions);                        \
     }                                                                         \
   };                                                                          \
   inline static OptionsInitializer _optionsInitializer;
@@ -1250,7 +4448,7 @@ class QSerializer {
       opts.skipEmpty = skipEmpty;                                            \
       opts.skipNull = skipNull;                                              \
       opts.skipNullLiterals = skipNullLiterals;                              \
-      QSerializer::setClassOptions(staticMetaObject.className(), opts);      \
+      QSerializer::setClassSkipOptions(staticMetaObject.className(), opts);  \
       initialized = true;                                                    \
     }                                                                        \
   }                                                                          \
@@ -1317,6 +4515,41 @@ class QSerializer {
 #define QS_MEMBER_SKIP_EMPTY_AND_NULL_LITERALS(className, memberName) \
   QS_MEMBER_SERIALIZE_OPTIONS(className, memberName, true, true, true)
 
+#define QS_MEMBER_XML_NUMBERS(className, memberName, form)            \
+  namespace {                                                         \
+  struct className##_##memberName##_xml_numbers_initializer {         \
+    className##_##memberName##_xml_numbers_initializer() {            \
+      QSerializer::setMemberXmlNumbers(#className, #memberName,       \
+                                       QSerializer::XmlNumber##form); \
+    }                                                                 \
+  };                                                                  \
+  static className##_##memberName##_xml_numbers_initializer           \
+      className##_##memberName##_xml_numbers;                         \
+  }
+
+#define QS_MEMBER_COMPACT_XML(className, memberName)                   \
+  namespace {                                                          \
+  struct className##_##memberName##_compact_xml_initializer {          \
+    className##_##memberName##_compact_xml_initializer() {             \
+      QSerializer::setMemberCompactXml(#className, #memberName, true); \
+    }                                                                  \
+  };                                                                   \
+  static className##_##memberName##_compact_xml_initializer            \
+      className##_##memberName##_compact_xml;                          \
+  }
+
+#define QS_MEMBER_XML_ATTRIBUTE(className, memberName)                   \
+  namespace {                                                            \
+  QS_CHECK_XML_VALUE(className::QS_XML_VALUE(memberName));               \
+  struct className##_##memberName##_xml_attribute_initializer {          \
+    className##_##memberName##_xml_attribute_initializer() {             \
+      QSerializer::setMemberXmlAttribute(#className, #memberName, true); \
+    }                                                                    \
+  };                                                                     \
+  static className##_##memberName##_xml_attribute_initializer            \
+      className##_##memberName##_xml_attribute;                          \
+  }
+
 #if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
 // C++17 or later - use inline static
 #define QS_INTERNAL_MEMBER_SERIALIZE_OPTIONS(memberName, skipEmpty, skipNull,  \
@@ -1365,20 +4598,174 @@ class QSerializer {
 
 #define QS_INTERNAL_MEMBER_SKIP_EMPTY_AND_NULL_LITERALS(memberName) \
   QS_INTERNAL_MEMBER_SERIALIZE_OPTIONS(memberName, true, true, true)
-#endif  // QSERIALIZER_H
 
-#ifndef QSERIALIZER_IMPLEMENTATION
-#define QSERIALIZER_IMPLEMENTATION
+/* XML form of the QS_XML_ARRAY collections of numbers, declared inside the
+ * class: Items (the default), Text or Base64 */
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define QS_INTERNAL_XML_NUMBERS(form)                                \
+ private:                                                            \
+  class XmlNumbersInitializer {                                      \
+   public:                                                           \
+    XmlNumbersInitializer() {                                        \
+      QSerializer::setClassXmlNumbers(staticMetaObject.className(),  \
+                                      QSerializer::XmlNumber##form); \
+    }                                                                \
+  };                                                                 \
+  inline static XmlNumbersInitializer _xmlNumbersInitializer;
+
+#define QS_INTERNAL_MEMBER_XML_NUMBERS(memberName, form)              \
+ private:                                                             \
+  class XmlNumbersInitializer_##memberName {                          \
+   public:                                                            \
+    XmlNumbersInitializer_##memberName() {                            \
+      QSerializer::setMemberXmlNumbers(staticMetaObject.className(),  \
+                                       #memberName,                   \
+                                       QSerializer::XmlNumber##form); \
+    }                                                                 \
+  };                                                                  \
+  inline static XmlNumbersInitializer_##memberName                    \
+      _xmlNumbersInit_##memberName;
+#else
+#define QS_INTERNAL_XML_NUMBERS(form)                                  \
+ private:                                                              \
+  class XmlNumbersInitializer {                                        \
+   public:                                                             \
+    XmlNumbersInitializer() {                                          \
+      static bool initialized = false;                                 \
+      if (!initialized) {                                              \
+        QSerializer::setClassXmlNumbers(staticMetaObject.className(),  \
+                                        QSerializer::XmlNumber##form); \
+        initialized = true;                                            \
+      }                                                                \
+    }                                                                  \
+  };                                                                   \
+  XmlNumbersInitializer _xmlNumbersInitializer;
+
+#define QS_INTERNAL_MEMBER_XML_NUMBERS(memberName, form)                \
+ private:                                                               \
+  class XmlNumbersInitializer_##memberName {                            \
+   public:                                                              \
+    XmlNumbersInitializer_##memberName() {                              \
+      static bool initialized = false;                                  \
+      if (!initialized) {                                               \
+        QSerializer::setMemberXmlNumbers(staticMetaObject.className(),  \
+                                         #memberName,                   \
+                                         QSerializer::XmlNumber##form); \
+        initialized = true;                                             \
+      }                                                                 \
+    }                                                                   \
+  };                                                                    \
+  XmlNumbersInitializer_##memberName _xmlNumbersInit_##memberName;
+#endif
 
-// Use conditional compilation to ensure that it is defined only once
+/* Compact XML arrays and dictionaries, declared inside the class */
 #if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
-// C++17 or later - use inline static
-inline QSerializer::OptionsMap QSerializer::s_classOptions;
-inline QSerializer::MemberOptionsMap QSerializer::s_memberOptions;
+#define QS_INTERNAL_COMPACT_XML                                            \
+ private:                                                                  \
+  class CompactXmlInitializer {                                            \
+   public:                                                                 \
+    CompactXmlInitializer() {                                              \
+      QSerializer::setClassCompactXml(staticMetaObject.className(), true); \
+    }                                                                      \
+  };                                                                       \
+  inline static CompactXmlInitializer _compactXmlInitializer;
+
+#define QS_INTERNAL_MEMBER_COMPACT_XML(memberName)                   \
+ private:                                                            \
+  class CompactXmlInitializer_##memberName {                         \
+   public:                                                           \
+    CompactXmlInitializer_##memberName() {                           \
+      QSerializer::setMemberCompactXml(staticMetaObject.className(), \
+                                       #memberName, true);           \
+    }                                                                \
+  };                                                                 \
+  inline static CompactXmlInitializer_##memberName                   \
+      _compactXmlInit_##memberName;
 #else
-// C++14 or earlier - use static member
-QSerializer::OptionsMap QSerializer::s_classOptions;
-QSerializer::MemberOptionsMap QSerializer::s_memberOptions;
+#define QS_INTERNAL_COMPACT_XML                                              \
+ private:                                                                    \
+  class CompactXmlInitializer {                                              \
+   public:                                                                   \
+    CompactXmlInitializer() {                                                \
+      static bool initialized = false;                                       \
+      if (!initialized) {                                                    \
+        QSerializer::setClassCompactXml(staticMetaObject.className(), true); \
+        initialized = true;                                                  \
+      }                                                                      \
+    }                                                                        \
+  };                                                                         \
+  CompactXmlInitializer _compactXmlInitializer;
+
+#define QS_INTERNAL_MEMBER_COMPACT_XML(memberName)                     \
+ private:                                                              \
+  class CompactXmlInitializer_##memberName {                           \
+   public:                                                             \
+    CompactXmlInitializer_##memberName() {                             \
+      static bool initialized = false;                                 \
+      if (!initialized) {                                              \
+        QSerializer::setMemberCompactXml(staticMetaObject.className(), \
+                                         #memberName, true);           \
+        initialized = true;                                            \
+      }                                                                \
+    }                                                                  \
+  };                                                                   \
+  CompactXmlInitializer_##memberName _compactXmlInit_##memberName;
 #endif
 
-#endif  // QSERIALIZER_IMPLEMENTATION
+/* XML attribute fields, declared inside the class */
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define QS_INTERNAL_XML_ATTRIBUTES                                            \
+ private:                                                                     \
+  class XmlAttributesInitializer {                                            \
+   public:                                                                    \
+    XmlAttributesInitializer() {                                              \
+      QSerializer::setClassXmlAttributes(staticMetaObject.className(), true); \
+    }                                                                         \
+  };                                                                          \
+  inline static XmlAttributesInitializer _xmlAttributesInitializer;
+
+#define QS_INTERNAL_MEMBER_XML_ATTRIBUTE(memberName)                   \
+ private:                                                              \
+  class XmlAttributeInitializer_##memberName {                         \
+   public:                                                             \
+    XmlAttributeInitializer_##memberName() {                           \
+      QS_CHECK_XML_VALUE(QS_XML_VALUE(memberName));                    \
+      QSerializer::setMemberXmlAttribute(staticMetaObject.className(), \
+                                         #memberName, true);           \
+    }                                                                  \
+  };                                                                   \
+  inline static XmlAttributeInitializer_##memberName                   \
+      _xmlAttributeInit_##memberName;
+#else
+#define QS_INTERNAL_XML_ATTRIBUTES                                       \
+ private:                                                                \
+  class XmlAttributesInitializer {                                       \
+   public:                                                               \
+    XmlAttributesInitializer() {                                         \
+      static bool initialized = false;                                   \
+      if (!initialized) {                                                \
+        QSerializer::setClassXmlAttributes(staticMetaObject.className(), \
+                                           true);                        \
+        initialized = true;                                              \
+      }                                                                  \
+    }                                                                    \
+  };                                                                     \
+  XmlAttributesInitializer _xmlAttributesInitializer;
+
+#define QS_INTERNAL_MEMBER_XML_ATTRIBUTE(memberName)                     \
+ private:                                                                \
+  class XmlAttributeInitializer_##memberName {                           \
+   public:                                                               \
+    XmlAttributeInitializer_##memberName() {                             \
+      QS_CHECK_XML_VALUE(QS_XML_VALUE(memberName));                      \
+      static bool initialized = false;                                   \
+      if (!initialized) {                                                \
+        QSerializer::setMemberXmlAttribute(staticMetaObject.className(), \
+                                           #memberName, true);           \
+        initialized = true;                                              \
+      }                                                                  \
+    }                                                                    \
+  };                                                                     \
+  XmlAttributeInitializer_##memberName _xmlAttributeInit_##memberName;
+#endif
+#endif  // QSERIALIZER_H
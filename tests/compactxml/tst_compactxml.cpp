@@ -0,0 +1,138 @@
+#include <QSerializer>
+#include <QTest>
+
+class Part : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(QString, name)
+};
+
+/* Every array and dictionary kind, all written in the compact form */
+class Inventory : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_COLLECTION(QVector, QString, names)
+QS_COLLECTION(QVector, int, counts)
+QS_COLLECTION_OBJECTS(QVector, Part, parts)
+QS_QT_DICT(QMap, QString, QString, labels)
+QS_STL_DICT(std::map, QString, int, totals)
+QS_QT_DICT_OBJECTS(QMap, QString, Part, partsByKey)
+QS_STL_DICT_OBJECTS(std::map, QString, Part, spares)
+};
+QS_COMPACT_XML(Inventory)
+
+/* Round-trips QS_COMPACT_XML arrays and dictionaries and compares them
+   with the default form */
+class TestCompactXml : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void roundTrip_data();
+    void roundTrip();
+    void noTypeAttributes();
+};
+
+static Part part(const QString& name) {
+    Part part;
+    part.name = name;
+    return part;
+}
+
+/* Keys that need escaping in an attribute value */
+static QStringList keys() {
+    return {"a&b", "<tag>", "\"quoted\"", "it's", "line\nbreak", "tab\there",
+            " spaced ", QString::fromUtf8("\xc3\xa9\xe4\xb8\xad"), ""};
+}
+
+static Inventory filled() {
+    Inventory inventory;
+    inventory.names = {"plain", "<&>", "", QString::fromUtf8("\xd0\x96")};
+    inventory.counts = {0, -1, 42};
+    inventory.parts = {part("x"), part("<y>")};
+    int i = 0;
+    for (const QString& key : keys()) {
+        inventory.labels.insert(key, key + "&value");
+        inventory.totals[key] = i;
+        inventory.partsByKey.insert(key, part(key));
+        inventory.spares[key] = part(QString::number(i));
+        i++;
+    }
+    return inventory;
+}
+
+static QByteArray compactXml(const Inventory& inventory) {
+    return inventory.toRawXml();
+}
+
+/* The default form, through a context that overrides the class option */
+static QByteArray defaultXml(const Inventory& inventory) {
+    QSerializer::SerializationContext ctx;
+    ctx.setClassOptions("Inventory", QSerializer::Options());
+    return inventory.toRawXml(ctx);
+}
+
+static void compare(const Inventory& actual, const Inventory& expected) {
+    QCOMPARE(actual.names, expected.names);
+    QCOMPARE(actual.counts, expected.counts);
+    QCOMPARE(actual.parts.size(), expected.parts.size());
+    for (int i = 0; i < actual.parts.size(); i++)
+        QCOMPARE(actual.parts[i].name, expected.parts[i].name);
+    QCOMPARE(actual.labels, expected.labels);
+    QVERIFY(actual.totals == expected.totals);
+    QCOMPARE(actual.partsByKey.keys(), expected.partsByKey.keys());
+    for (const QString& key : expected.partsByKey.keys())
+        QCOMPARE(actual.partsByKey.value(key).name,
+                 expected.partsByKey.value(key).name);
+    QCOMPARE(actual.spares.size(), expected.spares.size());
+    for (const auto& spare : expected.spares)
+        QCOMPARE(actual.spares.at(spare.first).name, spare.second.name);
+}
+
+void TestCompactXml::roundTrip_data() {
+    QTest::addColumn<bool>("empty");
+    QTest::addColumn<bool>("compact");
+
+    QTest::newRow("compact") << false << true;
+    QTest::newRow("compact_empty") << true << true;
+    QTest::newRow("default") << false << false;
+    QTest::newRow("default_empty") << true << false;
+}
+
+/* Arrays already in the object read into are replaced. Dictionaries are
+   merged outside update mode, so they start empty */
+void TestCompactXml::roundTrip() {
+    QFETCH(bool, empty);
+    QFETCH(bool, compact);
+    Inventory written = empty ? Inventory() : filled();
+    QByteArray xml = compact ? compactXml(written) : defaultXml(written);
+
+    Inventory read;
+    read.names = {"old"};
+    read.counts = {7};
+    read.parts = {part("old")};
+    read.fromXml(xml);
+    compare(read, written);
+}
+
+/* Neither the arrays and dictionaries nor their items carry a type or an
+   index */
+void TestCompactXml::noTypeAttributes() {
+    QDomDocument doc;
+    QVERIFY(doc.setContent(compactXml(filled())));
+    QDomElement root = doc.documentElement();
+    QCOMPARE(root.tagName(), QString("Inventory"));
+    for (QDomElement member = root.firstChildElement(); !member.isNull();
+         member = member.nextSiblingElement()) {
+        QVERIFY2(!member.hasAttribute("type"), qPrintable(member.tagName()));
+        for (QDomElement item = member.firstChildElement("item");
+             !item.isNull(); item = item.nextSiblingElement("item")) {
+            QVERIFY(!item.hasAttribute("type"));
+            QVERIFY(!item.hasAttribute("index"));
+        }
+    }
+
+    QVERIFY(defaultXml(filled()).contains("type=\"map\""));
+    QVERIFY(compactXml(filled()).size() < defaultXml(filled()).size());
+}
+
+QTEST_APPLESS_MAIN(TestCompactXml)
+#include "tst_compactxml.moc"
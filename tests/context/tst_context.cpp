@@ -0,0 +1,231 @@
+#include <QSerializer>
+#include <QTest>
+
+class Entry : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(int, id)
+};
+
+/* One member of every collection and dictionary kind updated in place */
+class State : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_COLLECTION(QVector, int, values)
+QS_QT_DICT(QMap, QString, int, counts)
+QS_STL_DICT(std::map, QString, QString, names)
+QS_COLLECTION_OBJECTS(QVector, Entry, entries)
+QS_QT_DICT_OBJECTS(QMap, QString, Entry, byName)
+};
+
+class Branch : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(int, id)
+QS_OBJECT(Entry, leaf)
+};
+
+/* Three levels of objects, a collection of each kind and a null member */
+class Tree : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(int, id)
+QS_FIELD_OPT(int, note)
+QS_OBJECT(Branch, branch)
+QS_COLLECTION(QVector, int, values)
+QS_COLLECTION_OBJECTS(QVector, Entry, entries)
+};
+
+class TestContext : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void reuseJson();
+    void reuseXml();
+    void limitsJson();
+    void limitsXml();
+    void overrides();
+};
+
+static Entry entry(int id) {
+    Entry entry;
+    entry.id = id;
+    return entry;
+}
+
+static State first() {
+    State state;
+    state.values = {1, 2, 3};
+    state.counts = {{"a", 1}, {"b", 2}};
+    state.names = {{"x", "1"}, {"y", "2"}};
+    state.entries = {entry(1), entry(2)};
+    state.byName = {{"p", entry(1)}, {"q", entry(2)}};
+    return state;
+}
+
+static State second() {
+    State state;
+    state.values = {4, 5};
+    state.counts = {{"a", 3}, {"c", 4}};
+    state.names = {{"x", "3"}};
+    state.entries = {entry(5)};
+    state.byName = {{"p", entry(6)}};
+    return state;
+}
+
+/* Reads the second message over the first one and checks that the elements
+   both messages have stay where they were */
+template <typename Read>
+static void checkReuse(Read read) {
+    QSerializer::SerializationContext ctx;
+    ctx.setReuseElements(true);
+    State state;
+    read(state, first(), ctx);
+    const int* values = state.values.constData();
+    const int* a = &state.counts.find("a").value();
+    const QString* x = &state.names.find("x")->second;
+    const Entry* entries = state.entries.constData();
+    const Entry* p = &state.byName.find("p").value();
+
+    read(state, second(), ctx);
+    QCOMPARE(state.values, QVector<int>({4, 5}));
+    QCOMPARE(state.counts, (QMap<QString, int>{{"a", 3}, {"c", 4}}));
+    QCOMPARE(state.names.size(), std::size_t(1));
+    QCOMPARE(state.names.at("x"), QString("3"));
+    QCOMPARE(state.entries.size(), 1);
+    QCOMPARE(state.entries[0].id, 5);
+    QCOMPARE(state.byName.size(), 1);
+    QCOMPARE(state.byName["p"].id, 6);
+
+    QCOMPARE(state.values.constData(), values);
+    QCOMPARE(&state.counts.find("a").value(), a);
+    QCOMPARE(&state.names.find("x")->second, x);
+    QCOMPARE(state.entries.constData(), entries);
+    QCOMPARE(&state.byName.find("p").value(), p);
+}
+
+void TestContext::reuseJson() {
+    checkReuse([](State& state, const State& message,
+                  QSerializer::SerializationContext& ctx) {
+        state.fromJson(message.toRawJson(), ctx);
+    });
+}
+
+void TestContext::reuseXml() {
+    checkReuse([](State& state, const State& message,
+                  QSerializer::SerializationContext& ctx) {
+        state.fromXml(message.toRawXml(), ctx);
+    });
+}
+
+static Tree tree() {
+    Tree tree;
+    tree.id = 1;
+    tree.branch.id = 2;
+    tree.branch.leaf.id = 3;
+    tree.values = {1, 2, 3};
+    tree.entries = {entry(1), entry(2), entry(3)};
+    return tree;
+}
+
+/* Reads a tree into one whose leaf is -1 */
+template <typename Read>
+static Tree readTree(Read read, QSerializer::SerializationContext& ctx) {
+    Tree result;
+    result.branch.leaf.id = -1;
+    read(result, tree(), ctx);
+    return result;
+}
+
+/* Objects below maxDepth are left untouched and collections stop at
+   maxCollectionSize; both set limitExceeded until it is cleared */
+template <typename Read>
+static void checkLimits(Read read) {
+    QSerializer::SerializationContext ctx;
+    ctx.setMaxDepth(2);
+    Tree result = readTree(read, ctx);
+    QVERIFY(ctx.limitExceeded());
+    QCOMPARE(result.id, 1);
+    QCOMPARE(result.branch.id, 2);
+    QCOMPARE(result.branch.leaf.id, -1);
+    QCOMPARE(result.entries.size(), 3);
+    QCOMPARE(result.entries[2].id, 3);
+
+    ctx.clearLimitExceeded();
+    ctx.setMaxDepth(3);
+    result = readTree(read, ctx);
+    QVERIFY(!ctx.limitExceeded());
+    QCOMPARE(result.branch.leaf.id, 3);
+
+    ctx.setMaxCollectionSize(2);
+    result = readTree(read, ctx);
+    QVERIFY(ctx.limitExceeded());
+    QCOMPARE(result.values, QVector<int>({1, 2}));
+    QCOMPARE(result.entries.size(), 2);
+    QCOMPARE(result.entries[1].id, 2);
+    QCOMPARE(result.branch.leaf.id, 3);
+
+    /* a context without limits reads everything */
+    QSerializer::SerializationContext other;
+    result = readTree(read, other);
+    QVERIFY(!other.limitExceeded());
+    QCOMPARE(result.values, QVector<int>({1, 2, 3}));
+    QCOMPARE(result.entries.size(), 3);
+}
+
+void TestContext::limitsJson() {
+    checkLimits([](Tree& result, const Tree& message,
+                   QSerializer::SerializationContext& ctx) {
+        result.fromJson(message.toRawJson(), ctx);
+    });
+    checkLimits([](Tree& result, const Tree& message,
+                   QSerializer::SerializationContext& ctx) {
+        result.fromJson(message.toJson(), ctx);
+    });
+}
+
+void TestContext::limitsXml() {
+    checkLimits([](Tree& result, const Tree& message,
+                   QSerializer::SerializationContext& ctx) {
+        result.fromXml(message.toRawXml(), ctx);
+    });
+    checkLimits([](Tree& result, const Tree& message,
+                   QSerializer::SerializationContext& ctx) {
+        result.fromXml(message.toXml(), ctx);
+    });
+}
+
+/* Options and limits set on one context apply to the calls made with it
+   only, not to other contexts nor to calls without one */
+void TestContext::overrides() {
+    QSerializer::Options skipNull;
+    skipNull.skipNull = true;
+    skipNull.skipNullLiterals = true;
+    QSerializer::SerializationContext ctx;
+    ctx.setMemberOptions("Tree", "note", skipNull);
+    ctx.setMaxCollectionSize(1);
+    QSerializer::SerializationContext other;
+
+    const Tree message = tree();
+    QVERIFY(!message.toJson(ctx).contains("note"));
+    QVERIFY(message.toJson(other).contains("note"));
+    QVERIFY(message.toJson().contains("note"));
+    QVERIFY(message.toXml(ctx).firstChildElement()
+                .firstChildElement("note").isNull());
+    QVERIFY(!message.toXml(other).firstChildElement()
+                 .firstChildElement("note").isNull());
+    QVERIFY(!message.toXml().firstChildElement()
+                 .firstChildElement("note").isNull());
+
+    Tree result;
+    result.fromJson(message.toJson(), ctx);
+    QCOMPARE(result.values.size(), 1);
+    result.fromJson(message.toJson(), other);
+    QCOMPARE(result.values.size(), 3);
+    result.fromJson(message.toJson());
+    QCOMPARE(result.values.size(), 3);
+    QVERIFY(ctx.limitExceeded());
+    QVERIFY(!other.limitExceeded());
+}
+
+QTEST_APPLESS_MAIN(TestContext)
+#include "tst_context.moc"
@@ -0,0 +1,14 @@
+QT -= gui
+QT += testlib
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QS_HAS_JSON QS_HAS_XML
+DEFINES += QS_ENABLE_PROFILING QS_ENABLE_TRACING
+
+TARGET = tst_instrumentation
+
+SOURCES += \
+        tst_instrumentation.cpp
+
+include(../../qserializer.pri)
@@ -0,0 +1,280 @@
+#include <QSerializer>
+#include <QTest>
+#include <functional>
+#include <type_traits>
+
+/* Built twice: with the instrumentation defines (instrumentation.pro) and
+   without them (noinstrumentation.pro) */
+
+class Inner : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(QString, name)
+};
+
+class Outer : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(int, id)
+QS_OBJECT(Inner, inner)
+};
+
+#define QS_TEST_STRING(...) #__VA_ARGS__
+#define QS_TEST_EXPANSION(...) QS_TEST_STRING(__VA_ARGS__)
+
+template <typename T, typename = void>
+struct HasProfiler : std::false_type {};
+template <typename T>
+struct HasProfiler<T, std::void_t<typename T::Profiler>> : std::true_type {};
+template <typename T, typename = void>
+struct HasTracer : std::false_type {};
+template <typename T>
+struct HasTracer<T, std::void_t<typename T::Tracer, typename T::ChromeTrace>>
+    : std::true_type {};
+
+class TestInstrumentation : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+#ifdef QS_ENABLE_PROFILING
+    void profiler();
+    void profilerAllocations();
+#else
+    void profilerCompiledOut();
+#endif
+#ifdef QS_ENABLE_TRACING
+    void tracer();
+    void tracerBytes();
+    void chromeTrace();
+#else
+    void tracerCompiledOut();
+#endif
+};
+
+static Outer outer() {
+    Outer outer;
+    outer.id = 7;
+    outer.inner.name = "x";
+    return outer;
+}
+
+#ifdef QS_ENABLE_PROFILING
+typedef QSerializer::Profiler Profiler;
+
+static Profiler::Counters counters(const char* className,
+                                   Profiler::Operation operation) {
+    const auto snapshot = Profiler::snapshot();
+    auto it = snapshot.find(className);
+    return it == snapshot.end() ? Profiler::Counters()
+                                : it->second[operation];
+}
+
+/* A raw call is recorded once, with its bytes; nested objects are recorded
+   under their own class */
+void TestInstrumentation::profiler() {
+    const QByteArray json = outer().toRawJson();
+    const QByteArray xml = outer().toRawXml();
+    Outer read;
+    const std::function<void()> calls[] = {
+        [] { outer().toRawJson(); }, [&] { read.fromJson(json); },
+        [] { outer().toRawXml(); }, [&] { read.fromXml(xml); }};
+    const Profiler::Operation operations[] = {
+        Profiler::ToJson, Profiler::FromJson, Profiler::ToXml,
+        Profiler::FromXml};
+    const qint64 bytes[] = {json.size(), json.size(), xml.size(), xml.size()};
+    for (int i = 0; i < 4; i++) {
+        Profiler::reset();
+        calls[i]();
+        const Profiler::Counters c = counters("Outer", operations[i]);
+        QCOMPARE(c.calls, quint64(1));
+        QCOMPARE(c.bytes, quint64(bytes[i]));
+        QVERIFY(c.maxNs <= c.totalNs);
+        quint64 histogram = 0;
+        for (quint64 count : c.histogram) histogram += count;
+        QCOMPARE(histogram, quint64(1));
+
+        const Profiler::Counters inner = counters("Inner", operations[i]);
+        QCOMPARE(inner.calls, quint64(1));
+        QCOMPARE(inner.bytes, quint64(0));
+    }
+    Profiler::reset();
+    outer().toRawJson();
+    QVERIFY(Profiler::dump().startsWith(
+        "[{\"class\":\"Inner\",\"operation\":\"toJson\",\"calls\":1,"));
+    QVERIFY(Profiler::dump().contains(
+        "{\"class\":\"Outer\",\"operation\":\"toJson\",\"calls\":1,"));
+
+    Profiler::reset();
+    QVERIFY(Profiler::snapshot().empty());
+    QCOMPARE(Profiler::dump(), QByteArray("[]"));
+}
+
+static quint64 s_allocations = 0;
+
+static quint64 countAllocations() {
+    return ++s_allocations;
+}
+
+/* Allocations come from the installed counter only */
+void TestInstrumentation::profilerAllocations() {
+    Profiler::reset();
+    outer().toJson();
+    QCOMPARE(counters("Outer", Profiler::ToJson).allocations, quint64(0));
+
+    Profiler::setAllocationCounter(&countAllocations);
+    Profiler::reset();
+    outer().toJson();
+    Profiler::setAllocationCounter(nullptr);
+    /* the inner call reads the counter twice inside the outer one */
+    QCOMPARE(counters("Outer", Profiler::ToJson).allocations, quint64(3));
+    QCOMPARE(counters("Inner", Profiler::ToJson).allocations, quint64(1));
+    Profiler::reset();
+}
+#else
+/* Without QS_ENABLE_PROFILING the macros expand to nothing and there is no
+   Profiler to call */
+void TestInstrumentation::profilerCompiledOut() {
+    static_assert(!HasProfiler<QSerializer>::value,
+                  "Profiler is compiled out");
+    QCOMPARE(QByteArray(QS_TEST_EXPANSION(QS_PROFILE(ToJson)
+                                          QS_PROFILE_RAW(FromJson)
+                                          QS_PROFILE_BYTES(1))),
+             QByteArray());
+    QVERIFY(outer().toRawJson().size() > 0);
+}
+#endif
+
+#ifdef QS_ENABLE_TRACING
+typedef QSerializer::Tracer Tracer;
+
+struct Recorded {
+    Tracer::Event event;
+    bool begin;
+};
+
+static std::vector<Recorded> s_events;
+
+static void recordBegin(const Tracer::Event& event, void*) {
+    s_events.push_back({event, true});
+}
+
+static void recordEnd(const Tracer::Event& event, void*) {
+    s_events.push_back({event, false});
+}
+
+/* The events of one format and direction as "B Class.property" and
+   "E Class.property bytes" */
+static QStringList events(Tracer::Format format, Tracer::Direction direction) {
+    QStringList list;
+    for (const Recorded& r : s_events) {
+        if (r.event.format != format || r.event.direction != direction) {
+            continue;
+        }
+        QString text = QString(r.begin ? "B " : "E ") +
+                       QString(r.event.className) + "." +
+                       QString(r.event.propertyName);
+        if (!r.begin) text += " " + QString::number(r.event.bytes);
+        list.append(text);
+    }
+    return list;
+}
+
+static QStringList expected(qint64 id, qint64 name, qint64 inner) {
+    return {"B Outer.id",
+            "E Outer.id " + QString::number(id),
+            "B Outer.inner",
+            "B Inner.name",
+            "E Inner.name " + QString::number(name),
+            "E Outer.inner " + QString::number(inner)};
+}
+
+/* Every property is reported in both directions and formats, nested ones
+   within their member; bytes are -1 unless measured */
+void TestInstrumentation::tracer() {
+    s_events.clear();
+    Tracer::setHooks(&recordBegin, &recordEnd);
+    const QJsonObject json = outer().toJson();
+    Outer read;
+    read.fromJson(json);
+    const QDomNode xml = outer().toXml();
+    /* reading XML also writes the nested object for its tag name */
+    const QStringList xmlWritten = events(Tracer::Xml, Tracer::Serialize);
+    read.fromXml(xml);
+    Tracer::setHooks(nullptr, nullptr);
+
+    QCOMPARE(events(Tracer::Json, Tracer::Serialize), expected(-1, -1, -1));
+    QCOMPARE(events(Tracer::Json, Tracer::Deserialize), expected(-1, -1, -1));
+    QCOMPARE(xmlWritten, expected(-1, -1, -1));
+    QCOMPARE(events(Tracer::Xml, Tracer::Deserialize), expected(-1, -1, -1));
+
+    /* removed hooks are not called */
+    s_events.clear();
+    outer().toJson();
+    QVERIFY(s_events.empty());
+}
+
+void TestInstrumentation::tracerBytes() {
+    s_events.clear();
+    Tracer::setHooks(&recordBegin, &recordEnd);
+    Tracer::setMeasureBytes(true);
+    const QJsonObject json = outer().toJson();
+    Outer read;
+    read.fromJson(json);
+    const QDomNode xml = outer().toXml();
+    Tracer::setMeasureBytes(false);
+    Tracer::setHooks(nullptr, nullptr);
+
+    /* 7, "x" and {"name":"x"} */
+    QCOMPARE(events(Tracer::Json, Tracer::Serialize), expected(1, 3, 12));
+    QCOMPARE(events(Tracer::Json, Tracer::Deserialize), expected(1, 3, 12));
+    const QDomElement root = xml.firstChildElement();
+    const QDomElement inner = root.firstChildElement("Inner");
+    QCOMPARE(events(Tracer::Xml, Tracer::Serialize),
+             expected(QSerializer::xmlSize(root.firstChildElement("id")),
+                      QSerializer::xmlSize(inner.firstChildElement("name")),
+                      QSerializer::xmlSize(inner)));
+}
+
+/* One B/E pair per property, in order, until the trace is uninstalled */
+void TestInstrumentation::chromeTrace() {
+    QSerializer::ChromeTrace trace;
+    trace.install();
+    outer().toJson();
+    trace.uninstall();
+    QVERIFY(!Tracer::userData());
+    outer().toJson();
+
+    const QJsonArray traceEvents =
+        QJsonDocument::fromJson(trace.toJson()).object()["traceEvents"]
+            .toArray();
+    QCOMPARE(traceEvents.size(), 6);
+    const char* const names[] = {"Outer.id",   "Outer.id",   "Outer.inner",
+                                 "Inner.name", "Inner.name", "Outer.inner"};
+    const QStringList phases = {"B", "E", "B", "B", "E", "E"};
+    double ts = 0;
+    for (int i = 0; i < 6; i++) {
+        const QJsonObject event = traceEvents[i].toObject();
+        QCOMPARE(event["name"].toString(), QString(names[i]));
+        QCOMPARE(event["cat"].toString(), QString("json,serialize"));
+        QCOMPARE(event["ph"].toString(), phases[i]);
+        QVERIFY(event["ts"].toDouble() >= ts);
+        ts = event["ts"].toDouble();
+        QVERIFY(!event.contains("args"));
+    }
+
+    trace.clear();
+    QCOMPARE(trace.toJson(), QByteArray("{\"traceEvents\":[]}"));
+}
+#else
+/* Without QS_ENABLE_TRACING the macros expand to nothing and there are no
+   Tracer and ChromeTrace */
+void TestInstrumentation::tracerCompiledOut() {
+    static_assert(!HasTracer<QSerializer>::value, "Tracer is compiled out");
+    QCOMPARE(QByteArray(QS_TEST_EXPANSION(QS_TRACE_FIELD(Json, Serialize, "id")
+                                          QS_TRACE_BYTES(1))),
+             QByteArray());
+    QVERIFY(outer().toRawXml().size() > 0);
+}
+#endif
+
+QTEST_APPLESS_MAIN(TestInstrumentation)
+#include "tst_instrumentation.moc"
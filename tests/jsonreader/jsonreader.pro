@@ -0,0 +1,14 @@
+QT -= gui
+QT += testlib
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QS_HAS_JSON
+DEFINES += QS_FAST_JSON_PARSER
+
+TARGET = tst_jsonreader
+
+SOURCES += \
+        tst_jsonreader.cpp
+
+include(../../qserializer.pri)
@@ -0,0 +1,78 @@
+#include <QSerializer>
+#include <QJsonDocument>
+#include <QTest>
+
+/* Dictionaries of simple values read without QVariant */
+class Values : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(QString, text)
+QS_QT_DICT(QMap, QString, QString, labels)
+QS_STL_DICT(std::map, QString, double, weights)
+};
+
+/* Compares QSerializer::JsonReader with QJsonDocument::fromJson. Both
+   results are written back with QJsonDocument, so a number that lost
+   precision shows up in the text even where QJsonValue::operator== would
+   compare the doubles only. */
+class TestJsonReader : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void parse_data();
+    void parse();
+    void rvalue();
+};
+
+void TestJsonReader::parse_data() {
+    QTest::addColumn<QByteArray>("input");
+
+    QTest::newRow("qint64_max") << QByteArray("{\"n\":9223372036854775807}");
+    QTest::newRow("qint64_min") << QByteArray("{\"n\":-9223372036854775808}");
+    QTest::newRow("above_max") << QByteArray("{\"n\":9223372036854775808}");
+    QTest::newRow("below_min") << QByteArray("{\"n\":-9223372036854775809}");
+    QTest::newRow("19_digits") << QByteArray("{\"n\":1000000000000000001}");
+    QTest::newRow("20_digits") << QByteArray("{\"n\":12345678901234567890}");
+    QTest::newRow("2^53+1") << QByteArray("{\"n\":9007199254740993}");
+    QTest::newRow("18_digits") << QByteArray("{\"n\":-999999999999999999}");
+    QTest::newRow("zero") << QByteArray("{\"a\":0,\"b\":-0}");
+    QTest::newRow("doubles")
+        << QByteArray("{\"a\":0.1,\"b\":1e3,\"c\":-2.5E-3}");
+    QTest::newRow("array")
+        << QByteArray("{\"a\":[9223372036854775807,-1,1.5,true,null]}");
+    QTest::newRow("strings")
+        << QByteArray("{\"s\":\"a\\\"b\\\\c\\n\\u00e9\\ud83d\\ude00\"}");
+}
+
+void TestJsonReader::parse() {
+    QFETCH(QByteArray, input);
+    QJsonObject actual;
+    QVERIFY(QSerializer::JsonReader::parse(input, actual));
+    QJsonParseError error;
+    QJsonObject expected = QJsonDocument::fromJson(input, &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(QJsonDocument(actual).toJson(QJsonDocument::Compact),
+             QJsonDocument(expected).toJson(QJsonDocument::Compact));
+}
+
+/* Raw data handed over with std::move reads like a copy and is released */
+void TestJsonReader::rvalue() {
+    const QByteArray input("{\"text\":\"a\",\"labels\":{\"x\":1,"
+                           "\"y\":\"\\u00e9\"},\"weights\":{\"w\":0.5}}");
+    Values copied;
+    copied.fromJson(input);
+    QByteArray data = input;
+    Values moved;
+    moved.fromJson(std::move(data));
+    QVERIFY(data.isEmpty());
+    QCOMPARE(moved.toRawJson(), copied.toRawJson());
+    QCOMPARE(moved.text, QString("a"));
+    QCOMPARE(moved.labels.value("x"), QString("1"));
+    QCOMPARE(moved.labels.value("y"), QString::fromUtf8("\xc3\xa9"));
+    QCOMPARE(moved.weights.at("w"), 0.5);
+
+    Values made = QSerializer::fromJson<Values>(QByteArray(input));
+    QCOMPARE(made.toRawJson(), copied.toRawJson());
+}
+
+QTEST_APPLESS_MAIN(TestJsonReader)
+#include "tst_jsonreader.moc"
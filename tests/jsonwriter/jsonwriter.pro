@@ -0,0 +1,13 @@
+QT -= gui
+QT += testlib
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QS_HAS_JSON
+
+TARGET = tst_jsonwriter
+
+SOURCES += \
+        tst_jsonwriter.cpp
+
+include(../../qserializer.pri)
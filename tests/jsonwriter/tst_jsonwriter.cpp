@@ -0,0 +1,194 @@
+#include <QSerializer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTest>
+#include <limits>
+
+/* Lines of text, as many as a test needs */
+class Notes : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_COLLECTION(QVector, QString, lines)
+};
+
+/* 64-bit integers written through toRawJson() */
+class Counters : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(qint64, largest)
+QS_FIELD(qint64, smallest)
+QS_FIELD(double, ratio)
+};
+
+/* Compares QSerializer::JsonWriter with QJsonDocument::toJson(Compact).
+   Qt 5 releases format some numbers differently, so there the documents
+   are compared after parsing them back. */
+class TestJsonWriter : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void write_data();
+    void write();
+    void sizeHint();
+    void rawJson();
+    void capacity();
+};
+
+static void compareJson(const QByteArray& actual, const QByteArray& expected) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QCOMPARE(actual, expected);
+#else
+    QJsonParseError error;
+    QJsonDocument parsed = QJsonDocument::fromJson(actual, &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(parsed, QJsonDocument::fromJson(expected));
+#endif
+}
+
+/* U+1F600, a surrogate pair in UTF-16 */
+static QString emoji() {
+    return QString() + QChar(QChar::highSurrogate(0x1f600)) +
+           QChar(QChar::lowSurrogate(0x1f600));
+}
+
+/* A string of length ASCII letters with special placed at position */
+static QString around(int length, int position, const QString& special) {
+    QString str;
+    for (int i = 0; i < length; i++)
+        str.append(QChar(ushort('a' + i % 26)));
+    return str.insert(position, special);
+}
+
+void TestJsonWriter::write_data() {
+    QTest::addColumn<QJsonObject>("object");
+
+    QTest::newRow("escapes") << QJsonObject{
+        {"s", "quote \" backslash \\ slash / \b\f\n\r\t end"}};
+
+    QString control;
+    for (ushort c = 0; c < 0x20; c++)
+        control.append(QChar(c));
+    control.append(QChar(ushort(0x7f)));
+    QTest::newRow("control") << QJsonObject{{"s", control}};
+
+    QTest::newRow("non_ascii") << QJsonObject{
+        {"s", QString::fromUtf8("\xc3\xa9 \xd0\x96 \xe4\xb8\xad \xe2\x82\xac")}};
+    QTest::newRow("surrogates") << QJsonObject{
+        {"s", emoji() + "x" + emoji() + emoji()}};
+    /* Unpaired surrogates are escaped as \uXXXX, also at a block end */
+    const QChar high(ushort(0xd83d)), low(ushort(0xde00));
+    QTest::newRow("lone_surrogates") << QJsonObject{
+        {"s", QString() + high + "x" + low + low + high + high + low + high}};
+    QTest::newRow("lone_surrogate_block") << QJsonObject{
+        {"s", around(40, 31, QString(high))}};
+    QTest::newRow("keys") << QJsonObject{
+        {"\"\n", 1}, {QString::fromUtf8("\xc3\xa9") + emoji(), 2}};
+
+    QTest::newRow("nan_inf") << QJsonObject{
+        {"nan", std::numeric_limits<double>::quiet_NaN()},
+        {"inf", std::numeric_limits<double>::infinity()},
+        {"-inf", -std::numeric_limits<double>::infinity()}};
+
+    QTest::newRow("large_integers") << QJsonObject{
+        {"max", std::numeric_limits<qint64>::max()},
+        {"min", std::numeric_limits<qint64>::min()},
+        {"2^53+1", qint64(9007199254740993LL)},
+        {"-2^53-1", qint64(-9007199254740993LL)},
+        {"2^60+1", qint64(1152921504606846977LL)},
+        {"int", 123456789}};
+
+    QTest::newRow("doubles") << QJsonObject{
+        {"a", 0.1},
+        {"b", 1e6},
+        {"c", 100000.0},
+        {"d", 1e21},
+        {"e", 1e-7},
+        {"f", 123.456},
+        {"g", std::numeric_limits<double>::denorm_min()},
+        {"h", std::numeric_limits<double>::max()},
+        {"i", -2.5}};
+
+    QTest::newRow("negative_zero") << QJsonObject{{"z", -0.0}};
+
+    QTest::newRow("nested") << QJsonObject{
+        {"array", QJsonArray{1, "two", QJsonArray{}, QJsonObject{}, true,
+                             QJsonValue()}},
+        {"object", QJsonObject{{"inner", QJsonArray{false, 2.5}}}}};
+
+    /* Specials at the edges of the 16 and 32 unit blocks of the SSE2 and
+       AVX2 kernels, in short and long strings */
+    const int lengths[] = {15, 16, 17, 31, 32, 33, 47, 48, 63, 64, 65,
+                           255, 256, 257, 300};
+    const QString specials[] = {"\"", "\n", QString::fromUtf8("\xc3\xa9"),
+                                emoji()};
+    const char* names[] = {"quote", "newline", "latin", "emoji"};
+    for (int length : lengths) {
+        for (int s = 0; s < 4; s++) {
+            const int positions[] = {0, length / 2, length - 1, length};
+            for (int position : positions) {
+                QString tag = QString("block_%1_%2_%3")
+                                  .arg(length)
+                                  .arg(names[s])
+                                  .arg(position);
+                QTest::newRow(qPrintable(tag)) << QJsonObject{
+                    {"s", around(length, position, specials[s])}};
+            }
+        }
+    }
+}
+
+void TestJsonWriter::write() {
+    QFETCH(QJsonObject, object);
+    compareJson(QSerializer::JsonWriter::write(object),
+                QJsonDocument(object).toJson(QJsonDocument::Compact));
+}
+
+/* Too small and too large hints give the same text */
+void TestJsonWriter::sizeHint() {
+    QJsonObject object{{"s", around(1000, 500, emoji())},
+                       {"n", QJsonArray{1, 2.5, -3}}};
+    QByteArray text = QSerializer::JsonWriter::write(object);
+    QCOMPARE(QSerializer::JsonWriter::write(object, 1), text);
+    QCOMPARE(QSerializer::JsonWriter::write(object, 1 << 20), text);
+    QVERIFY(QSerializer::JsonWriter::estimate(object) >= 1000);
+}
+
+void TestJsonWriter::rawJson() {
+    Counters counters;
+    counters.largest = std::numeric_limits<qint64>::max();
+    counters.smallest = std::numeric_limits<qint64>::min();
+    counters.ratio = 0.5;
+    QByteArray expected =
+        QJsonDocument(counters.toJson()).toJson(QJsonDocument::Compact);
+    // the second call starts from the size hint of the first
+    compareJson(counters.toRawJson(), expected);
+    compareJson(counters.toRawJson(), expected);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QVERIFY(expected.contains("9223372036854775807"));
+#endif
+}
+
+static bool tight(const QByteArray& text) {
+    return text.capacity() - text.size() <= text.size() / 8 + 64;
+}
+
+/* Outputs hold little more memory than their text, also right after a
+   much larger output of the same class */
+void TestJsonWriter::capacity() {
+    QVERIFY(tight(QSerializer::JsonWriter::write(QJsonObject{{"n", 1}})));
+    QVERIFY(tight(QSerializer::JsonWriter::write(
+        QJsonObject{{"s", QString(300, QChar(ushort(0xe9)))}})));
+
+    Notes notes;
+    for (int i = 0; i < 10000; i++)
+        notes.lines.append(QString("line %1 \n").arg(i));
+    QVERIFY(tight(notes.toRawJson()));
+    notes.lines = {"short"};
+    for (int i = 0; i < 3; i++) {
+        QByteArray text = notes.toRawJson();
+        QCOMPARE(text, QByteArray("{\"lines\":[\"short\"]}"));
+        QVERIFY(tight(text));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestJsonWriter)
+#include "tst_jsonwriter.moc"
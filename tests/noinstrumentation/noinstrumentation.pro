@@ -0,0 +1,14 @@
+QT -= gui
+QT += testlib
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QS_HAS_JSON QS_HAS_XML
+
+# the instrumentation suite without the instrumentation defines
+TARGET = tst_noinstrumentation
+
+SOURCES += \
+        ../instrumentation/tst_instrumentation.cpp
+
+include(../../qserializer.pri)
@@ -0,0 +1,238 @@
+#include <QSerializer>
+#include <QJsonDocument>
+#include <QTest>
+#include <limits>
+
+/* Compares the number formatting of QSerializer with QVariant::toString(),
+   which the XML writer and JSON keys used before, and with the numbers of
+   QJsonDocument::toJson(Compact). Qt 5 releases format some doubles
+   differently in JSON, so there only QVariant is compared. Parsing is
+   compared with QVariant::value(). */
+class TestNumbers : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void formatInteger_data();
+    void formatInteger();
+    void formatUnsigned_data();
+    void formatUnsigned();
+    void formatDouble_data();
+    void formatDouble();
+    void formatFloat_data();
+    void formatFloat();
+    void parseInteger_data();
+    void parseInteger();
+    void parseFloating_data();
+    void parseFloating();
+};
+
+template <typename T>
+static QString integer(T value) {
+    char text[QSerializer::kNumberBufferSize];
+    char* end = QSerializer::formatInteger(text, value);
+    return QString::fromLatin1(text, int(end - text));
+}
+
+void TestNumbers::formatInteger_data() {
+    QTest::addColumn<qint64>("value");
+
+    QTest::newRow("zero") << qint64(0);
+    QTest::newRow("nine") << qint64(9);
+    QTest::newRow("ten") << qint64(10);
+    QTest::newRow("hundred") << qint64(100);
+    QTest::newRow("minus_one") << qint64(-1);
+    QTest::newRow("minus_99") << qint64(-99);
+    QTest::newRow("int_max") << qint64(std::numeric_limits<int>::max());
+    QTest::newRow("int_min") << qint64(std::numeric_limits<int>::min());
+    QTest::newRow("2^53") << (qint64(1) << 53);
+    QTest::newRow("qint64_max") << std::numeric_limits<qint64>::max();
+    QTest::newRow("qint64_min") << std::numeric_limits<qint64>::min();
+}
+
+/* Values in the range of int are checked as int too */
+void TestNumbers::formatInteger() {
+    QFETCH(qint64, value);
+    QCOMPARE(integer(value), QVariant(value).toString());
+    QCOMPARE(QSerializer::toText(value), QVariant(value).toString());
+    if (value >= std::numeric_limits<int>::min() &&
+        value <= std::numeric_limits<int>::max()) {
+        QCOMPARE(integer(int(value)), QVariant(int(value)).toString());
+        QCOMPARE(QSerializer::toText(int(value)),
+                 QVariant(int(value)).toString());
+    }
+}
+
+void TestNumbers::formatUnsigned_data() {
+    QTest::addColumn<quint64>("value");
+
+    QTest::newRow("zero") << quint64(0);
+    QTest::newRow("uint_max") << quint64(std::numeric_limits<uint>::max());
+    QTest::newRow("above_qint64")
+        << quint64(std::numeric_limits<qint64>::max()) + 1;
+    QTest::newRow("quint64_max") << std::numeric_limits<quint64>::max();
+}
+
+void TestNumbers::formatUnsigned() {
+    QFETCH(quint64, value);
+    QCOMPARE(integer(value), QVariant(value).toString());
+    if (value <= std::numeric_limits<uint>::max()) {
+        QCOMPARE(integer(uint(value)), QVariant(uint(value)).toString());
+    }
+}
+
+void TestNumbers::formatDouble_data() {
+    QTest::addColumn<double>("value");
+
+    QTest::newRow("zero") << 0.0;
+    QTest::newRow("minus_zero") << -0.0;
+    QTest::newRow("one") << 1.0;
+    QTest::newRow("tenth") << 0.1;
+    QTest::newRow("third") << 1.0 / 3;
+    QTest::newRow("negative") << -2.5e-3;
+    QTest::newRow("1e-4") << 1e-4;
+    QTest::newRow("1e-5") << 1e-5;
+    QTest::newRow("1e-7") << 1e-7;
+    QTest::newRow("1e15") << 1e15;
+    QTest::newRow("1e16") << 1e16;
+    QTest::newRow("2^53+2") << 9007199254740994.0;
+    QTest::newRow("1e20") << 1e20;
+    QTest::newRow("1e21") << 1e21;
+    QTest::newRow("1.5e21") << 1.5e21;
+    QTest::newRow("1e-21") << 1e-21;
+    QTest::newRow("1e100") << 1e100;
+    QTest::newRow("max") << std::numeric_limits<double>::max();
+    QTest::newRow("lowest") << std::numeric_limits<double>::lowest();
+    QTest::newRow("min_normal") << std::numeric_limits<double>::min();
+    QTest::newRow("max_subnormal")
+        << std::numeric_limits<double>::min() -
+               std::numeric_limits<double>::denorm_min();
+    QTest::newRow("min_subnormal")
+        << std::numeric_limits<double>::denorm_min();
+    QTest::newRow("nan") << std::numeric_limits<double>::quiet_NaN();
+    QTest::newRow("inf") << std::numeric_limits<double>::infinity();
+    QTest::newRow("minus_inf") << -std::numeric_limits<double>::infinity();
+}
+
+/* QJsonDocument writes NaN and infinities as null, so only finite values
+   are compared with it */
+void TestNumbers::formatDouble() {
+    QFETCH(double, value);
+    char text[QSerializer::kNumberBufferSize];
+    const QByteArray actual(text,
+                            int(QSerializer::formatDouble(text, value) - text));
+    QCOMPARE(QString::fromLatin1(actual), QVariant(value).toString());
+    QCOMPARE(QSerializer::toText(value), QVariant(value).toString());
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    if (std::isfinite(value)) {
+        QByteArray json = QJsonDocument(QJsonObject{{"n", value}})
+                              .toJson(QJsonDocument::Compact);
+        QCOMPARE(actual, json.mid(5, json.size() - 6));
+    }
+#endif
+}
+
+void TestNumbers::formatFloat_data() {
+    QTest::addColumn<float>("value");
+
+    QTest::newRow("zero") << 0.0f;
+    QTest::newRow("minus_zero") << -0.0f;
+    QTest::newRow("tenth") << 0.1f;
+    QTest::newRow("third") << 1.0f / 3;
+    QTest::newRow("2^24+2") << 16777218.0f;
+    QTest::newRow("1e21") << 1e21f;
+    QTest::newRow("max") << std::numeric_limits<float>::max();
+    QTest::newRow("min_normal") << std::numeric_limits<float>::min();
+    QTest::newRow("min_subnormal") << std::numeric_limits<float>::denorm_min();
+    QTest::newRow("nan") << std::numeric_limits<float>::quiet_NaN();
+    QTest::newRow("inf") << std::numeric_limits<float>::infinity();
+}
+
+/* Float members are formatted from the float itself, not from the double
+   it widens to */
+void TestNumbers::formatFloat() {
+    QFETCH(float, value);
+    QCOMPARE(QSerializer::toText(value), QVariant(value).toString());
+}
+
+/* Text that is not a number of the type, or is out of its range, gives 0
+   like QVariant; the rows that from_chars does not take whole go through
+   QVariant itself */
+void TestNumbers::parseInteger_data() {
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("zero") << "0";
+    QTest::newRow("minus_zero") << "-0";
+    QTest::newRow("leading_zeros") << "007";
+    QTest::newRow("negative") << "-42";
+    QTest::newRow("plus") << "+42";
+    QTest::newRow("plus_minus") << "+-42";
+    QTest::newRow("plus_alone") << "+";
+    QTest::newRow("spaces") << "  42\t";
+    QTest::newRow("inner_space") << "4 2";
+    QTest::newRow("int_max") << "2147483647";
+    QTest::newRow("above_int") << "2147483648";
+    QTest::newRow("int_min") << "-2147483648";
+    QTest::newRow("below_int") << "-2147483649";
+    QTest::newRow("uint_max") << "4294967295";
+    QTest::newRow("above_uint") << "4294967296";
+    QTest::newRow("qint64_max") << "9223372036854775807";
+    QTest::newRow("above_qint64") << "9223372036854775808";
+    QTest::newRow("qint64_min") << "-9223372036854775808";
+    QTest::newRow("quint64_max") << "18446744073709551615";
+    QTest::newRow("above_quint64") << "18446744073709551616";
+    QTest::newRow("long") << "000000000000000000000000000000000042";
+    QTest::newRow("hex") << "0x1f";
+    QTest::newRow("fraction") << "1.5";
+    QTest::newRow("exponent") << "1e3";
+    QTest::newRow("letters") << "abc";
+    QTest::newRow("trailing") << "12abc";
+    QTest::newRow("empty") << "";
+    QTest::newRow("arabic_digits") << QString::fromUtf8("\xd9\xa4\xd9\xa2");
+}
+
+void TestNumbers::parseInteger() {
+    QFETCH(QString, text);
+    QCOMPARE(QSerializer::fromText<int>(text), QVariant(text).value<int>());
+    QCOMPARE(QSerializer::fromText<uint>(text), QVariant(text).value<uint>());
+    QCOMPARE(QSerializer::fromText<qint64>(text),
+             QVariant(text).value<qint64>());
+    QCOMPARE(QSerializer::fromText<quint64>(text),
+             QVariant(text).value<quint64>());
+}
+
+void TestNumbers::parseFloating_data() {
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("zero") << "0";
+    QTest::newRow("minus_zero") << "-0";
+    QTest::newRow("tenth") << "0.1";
+    QTest::newRow("no_integer_part") << ".5";
+    QTest::newRow("no_fraction") << "5.";
+    QTest::newRow("plus") << "+1.5";
+    QTest::newRow("spaces") << " 1.5 ";
+    QTest::newRow("exponent") << "1e21";
+    QTest::newRow("negative_exponent") << "-2.5E-3";
+    QTest::newRow("plus_exponent") << "1e+5";
+    QTest::newRow("max") << "1.7976931348623157e+308";
+    QTest::newRow("overflow") << "1e400";
+    QTest::newRow("min_subnormal") << "5e-324";
+    QTest::newRow("underflow") << "1e-400";
+    QTest::newRow("float_overflow") << "1e39";
+    QTest::newRow("float_subnormal") << "1e-45";
+    QTest::newRow("nan") << "nan";
+    QTest::newRow("inf") << "inf";
+    QTest::newRow("minus_inf") << "-inf";
+    QTest::newRow("hex") << "0x1p3";
+    QTest::newRow("comma") << "1,5";
+    QTest::newRow("letters") << "abc";
+    QTest::newRow("empty") << "";
+}
+
+void TestNumbers::parseFloating() {
+    QFETCH(QString, text);
+    QCOMPARE(QSerializer::fromText<double>(text),
+             QVariant(text).value<double>());
+    QCOMPARE(QSerializer::fromText<float>(text), QVariant(text).value<float>());
+}
+
+QTEST_APPLESS_MAIN(TestNumbers)
+#include "tst_numbers.moc"
@@ -0,0 +1,165 @@
+#include <QSerializer>
+#include <QTest>
+
+class Item : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(QString, sku)
+QS_FIELD(int, qty)
+};
+
+/* One member of each kind the report recurses into, and a null note that
+   the class options skip in both formats */
+class Order : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_INTERNAL_SERIALIZE_OPTIONS(false, true, true)
+QS_FIELD(QString, id)
+QS_FIELD_OPT(QString, note)
+QS_OBJECT(Item, main)
+QS_COLLECTION_OBJECTS(QVector, Item, items)
+QS_QT_DICT_OBJECTS(QMap, QString, Item, byKey)
+QS_COLLECTION(QVector, int, codes)
+};
+
+/* Compares the report with the size of the serialized document and checks
+   that the members of every node add up to it */
+class TestSizeReport : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void json();
+    void xml();
+    void skipped();
+};
+
+static Item item(const QString& sku, int qty) {
+    Item item;
+    item.sku = sku;
+    item.qty = qty;
+    return item;
+}
+
+static Order order() {
+    Order order;
+    order.id = "o-1 \"quoted\" <&>";
+    order.main = item("m", 1);
+    order.items = {item("a", 2), item("bb", 30), item("ccc", 400)};
+    order.byKey = {{"k1", item("x", 5)}, {"key <2>", item("y", 60)}};
+    order.codes = {7, 8, 9};
+    return order;
+}
+
+static const QSerializer::SizeNode* find(const QSerializer::SizeNode& node,
+                                         const char* name) {
+    for (const QSerializer::SizeNode& child : node.children) {
+        if (child.name == name) return &child;
+    }
+    return nullptr;
+}
+
+static qint64 childBytes(const QSerializer::SizeNode& node) {
+    qint64 bytes = 0;
+    for (const QSerializer::SizeNode& child : node.children) {
+        bytes += child.bytes;
+    }
+    return bytes;
+}
+
+/* "name":value in compact JSON */
+static qint64 jsonMember(const QJsonObject& json, const char* name) {
+    return qint64(strlen(name)) + 3 + QSerializer::jsonSize(json.value(name));
+}
+
+void TestSizeReport::json() {
+    const Order o = order();
+    const QSerializer::SizeNode report = o.jsonSizeReport();
+    const QJsonObject json = o.toJson();
+    QCOMPARE(report.bytes,
+             qint64(QJsonDocument(json).toJson(QJsonDocument::Compact).size()));
+    QCOMPARE(report.count, qint64(1));
+
+    /* {} and the commas around the members */
+    QCOMPARE(report.bytes,
+             2 + qint64(report.children.size()) - 1 + childBytes(report));
+    for (const QSerializer::SizeNode& child : report.children) {
+        QCOMPARE(child.bytes, jsonMember(json, child.name.c_str()));
+    }
+
+    /* "main":{} and its comma */
+    const QSerializer::SizeNode* main = find(report, "main");
+    QVERIFY(main);
+    QCOMPARE(main->bytes, 4 + 3 + 2 + 1 + childBytes(*main));
+
+    /* "items":[] with its commas, and {} with one comma per item */
+    const QSerializer::SizeNode* items = find(report, "items");
+    QVERIFY(items);
+    QCOMPARE(items->children.size(), size_t(2));
+    QCOMPARE(find(*items, "sku")->count, qint64(3));
+    QCOMPARE(find(*items, "sku")->bytes, qint64(3 * (6 + 2) + 1 + 2 + 3));
+    QCOMPARE(items->bytes, 5 + 3 + 2 + 2 + 3 * 3 + childBytes(*items));
+
+    /* "byKey":{} with its commas, and "key":{} with one comma per item */
+    const QSerializer::SizeNode* byKey = find(report, "byKey");
+    QVERIFY(byKey);
+    const qint64 keys = QSerializer::jsonSize(QJsonValue("k1")) + 1 +
+                        QSerializer::jsonSize(QJsonValue("key <2>")) + 1;
+    QCOMPARE(byKey->bytes, 5 + 3 + 2 + 1 + keys + 2 * 3 + childBytes(*byKey));
+
+    /* scalars and collections of scalars have no children */
+    QVERIFY(find(report, "codes")->children.empty());
+    QVERIFY(find(report, "id")->children.empty());
+}
+
+void TestSizeReport::xml() {
+    const Order o = order();
+    const QSerializer::SizeNode report = o.xmlSizeReport();
+    const QDomElement root = o.toXml().firstChildElement();
+    QCOMPARE(report.bytes, QSerializer::xmlSize(root));
+
+    /* <Order>members</Order> */
+    QCOMPARE(report.bytes, 7 + childBytes(report) + 8);
+
+    /* the nested object is written as its class element */
+    const QSerializer::SizeNode* main = find(report, "main");
+    QVERIFY(main);
+    QCOMPARE(main->bytes, QSerializer::xmlSize(root.firstChildElement("Item")));
+    QCOMPARE(main->bytes, 6 + childBytes(*main) + 7);
+
+    const QSerializer::SizeNode* items = find(report, "items");
+    QVERIFY(items);
+    QCOMPARE(items->bytes,
+             QSerializer::xmlSize(root.firstChildElement("items")));
+    QCOMPARE(find(*items, "qty")->count, qint64(3));
+
+    const QSerializer::SizeNode* byKey = find(report, "byKey");
+    QVERIFY(byKey);
+    QCOMPARE(byKey->bytes,
+             QSerializer::xmlSize(root.firstChildElement("byKey")));
+    QCOMPARE(QSerializer::xmlSize(root.firstChildElement("codes")),
+             find(report, "codes")->bytes);
+    QCOMPARE(find(report, "id")->bytes,
+             QSerializer::xmlSize(root.firstChildElement("id")));
+}
+
+/* The skipped note has no node; emitted, it has one in both formats */
+void TestSizeReport::skipped() {
+    const Order o = order();
+    QVERIFY(!find(o.jsonSizeReport(), "note"));
+    QVERIFY(!find(o.xmlSizeReport(), "note"));
+
+    QSerializer::SerializationContext ctx;
+    ctx.setDefaultOptions(QSerializer::Options());
+    const QSerializer::SizeNode json = o.jsonSizeReport(ctx);
+    QVERIFY(find(json, "note"));
+    QCOMPARE(find(json, "note")->bytes, qint64(4 + 3 + 4));
+    QCOMPARE(json.bytes, qint64(QJsonDocument(o.toJson(ctx))
+                                    .toJson(QJsonDocument::Compact)
+                                    .size()));
+    const QSerializer::SizeNode xml = o.xmlSizeReport(ctx);
+    QVERIFY(find(xml, "note"));
+    QCOMPARE(xml.bytes,
+             QSerializer::xmlSize(o.toXml(ctx).firstChildElement()));
+}
+
+QTEST_APPLESS_MAIN(TestSizeReport)
+#include "tst_sizereport.moc"
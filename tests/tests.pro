@@ -0,0 +1,14 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    compactxml \
+    context \
+    instrumentation \
+    jsonreader \
+    jsonwriter \
+    noinstrumentation \
+    numbers \
+    sizereport \
+    xmlattributes \
+    xmlnumbers \
+    xmlwriter
@@ -0,0 +1,148 @@
+#include <QSerializer>
+#include <QTest>
+
+/* An object that writes no attributes and no children when text is empty */
+class Tag : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_INTERNAL_SERIALIZE_OPTIONS(true, false, false)
+QS_FIELD(QString, text)
+};
+
+/* Fields chosen one by one */
+class Point : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_INTERNAL_MEMBER_XML_ATTRIBUTE(label)
+QS_INTERNAL_MEMBER_XML_ATTRIBUTE(weight)
+QS_FIELD(int, x)
+QS_FIELD(QString, label)
+QS_FIELD_OPT(int, weight)
+};
+
+/* The whole class in the attribute mode, with members that must stay
+   elements */
+class Shape : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(QString, name)
+QS_FIELD_OPT(QString, note)
+QS_OBJECT(Tag, tag)
+QS_OBJECT_OPT(Point, anchor)
+QS_COLLECTION(QVector, int, sizes)
+QS_COLLECTION_OBJECTS(QVector, Point, points)
+};
+QS_XML_ATTRIBUTES(Shape)
+QS_MEMBER_COMPACT_XML(Shape, sizes)
+
+class TestXmlAttributes : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void fields();
+    void emptyAndNull();
+    void roundTrip();
+    void nested();
+};
+
+static QDomElement root(const QSerializer& object) {
+    return object.toXml().firstChildElement();
+}
+
+void TestXmlAttributes::fields() {
+    Point point;
+    point.x = 3;
+    point.label = "a";
+    point.weight = 2;
+    QDomElement element = root(point);
+    QCOMPARE(element.attribute("label"), QString("a"));
+    QCOMPARE(element.attribute("weight"), QString("2"));
+    QVERIFY(!element.hasAttribute("x"));
+    QCOMPARE(element.firstChildElement("x").text(), QString("3"));
+
+    Point read;
+    read.fromXml(point.toXml());
+    QCOMPARE(read.x, 3);
+    QCOMPARE(read.label, QString("a"));
+    QCOMPARE(read.weight, std::optional<int>(2));
+}
+
+/* Only the two fields become attributes; the empty object, the null
+   object and the empty compact array are written as elements */
+void TestXmlAttributes::emptyAndNull() {
+    Shape shape;
+    QDomElement element = root(shape);
+    QCOMPARE(element.attributes().count(), 2);
+    QVERIFY(element.hasAttribute("name"));
+    QCOMPARE(element.attribute("name"), QString());
+    QCOMPARE(element.attribute("note"), QString("null"));
+    QVERIFY(!element.firstChildElement("Tag").isNull());
+    QVERIFY(!element.firstChildElement("Tag").hasChildNodes());
+    QCOMPARE(element.firstChildElement("anchor").text(), QString("null"));
+    QVERIFY(!element.firstChildElement("sizes").isNull());
+    QVERIFY(!element.firstChildElement("sizes").hasChildNodes());
+
+    Point point;
+    element = root(point);
+    QCOMPARE(element.attribute("label"), QString());
+    QCOMPARE(element.attribute("weight"), QString("null"));
+}
+
+void TestXmlAttributes::roundTrip() {
+    Shape empty;
+    Shape read;
+    read.name = "old";
+    read.note = QString("old");
+    read.sizes = {1, 2};
+    read.fromXml(empty.toXml());
+    QCOMPARE(read.name, QString());
+    QVERIFY(!read.note.has_value());
+    QCOMPARE(read.tag.text, QString());
+    QVERIFY(read.sizes.isEmpty());
+    QVERIFY(!read.anchor.has_value());
+
+    Point point;
+    point.label = "old";
+    point.weight = 1;
+    point.fromXml(Point().toXml());
+    QCOMPARE(point.label, QString());
+    QVERIFY(!point.weight.has_value());
+}
+
+/* Nested objects get their class element, which holds their attributes */
+void TestXmlAttributes::nested() {
+    Shape shape;
+    shape.anchor = Point();
+    shape.anchor->x = 1;
+    shape.anchor->label = "anchor";
+    shape.anchor->weight = 5;
+    for (int i = 0; i < 3; i++) {
+        Point point;
+        point.x = i;
+        point.label = QString("p%1").arg(i);
+        if (i != 1) point.weight = i * 10;
+        shape.points.append(point);
+    }
+    QDomElement anchor = root(shape).firstChildElement("Point");
+    QCOMPARE(anchor.attribute("label"), QString("anchor"));
+
+    Shape read;
+    read.fromXml(shape.toXml());
+    QVERIFY(read.anchor.has_value());
+    QCOMPARE(read.anchor->x, 1);
+    QCOMPARE(read.anchor->label, QString("anchor"));
+    QCOMPARE(read.anchor->weight, std::optional<int>(5));
+    QCOMPARE(read.points.size(), 3);
+    for (int i = 0; i < 3; i++) {
+        QCOMPARE(read.points[i].x, i);
+        QCOMPARE(read.points[i].label, QString("p%1").arg(i));
+        QCOMPARE(read.points[i].weight,
+                 i != 1 ? std::optional<int>(i * 10) : std::nullopt);
+    }
+
+    /* and a null anchor read into an object that has one */
+    read.fromXml(Shape().toXml());
+    QVERIFY(!read.anchor.has_value());
+}
+
+QTEST_APPLESS_MAIN(TestXmlAttributes)
+#include "tst_xmlattributes.moc"
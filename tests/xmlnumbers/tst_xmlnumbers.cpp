@@ -0,0 +1,138 @@
+#include <QSerializer>
+#include <QTest>
+#include <limits>
+
+/* Collections of numbers of several widths */
+class Samples : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_COLLECTION(QVector, int, counts)
+QS_COLLECTION(QVector, double, values)
+QS_COLLECTION(QVector, quint64, ids)
+};
+
+/* Round-trips the packed XML forms of number collections and reads
+   payloads that packXmlNumbers() would not write */
+class TestXmlNumbers : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void roundTrip_data();
+    void roundTrip();
+    void unpack_data();
+    void unpack();
+    void littleEndian();
+};
+
+static Samples samples() {
+    Samples samples;
+    samples.counts = {0, -1, std::numeric_limits<int>::min(),
+                      std::numeric_limits<int>::max()};
+    samples.values = {1.5, -0.0, 3e20, 0.1,
+                      std::numeric_limits<double>::denorm_min()};
+    samples.ids = {0, std::numeric_limits<quint64>::max()};
+    return samples;
+}
+
+void TestXmlNumbers::roundTrip_data() {
+    QTest::addColumn<int>("form");
+    QTest::addColumn<bool>("empty");
+
+    QTest::newRow("items") << int(QSerializer::XmlNumberItems) << false;
+    QTest::newRow("text") << int(QSerializer::XmlNumberText) << false;
+    QTest::newRow("base64") << int(QSerializer::XmlNumberBase64) << false;
+    QTest::newRow("text_empty") << int(QSerializer::XmlNumberText) << true;
+    QTest::newRow("base64_empty") << int(QSerializer::XmlNumberBase64) << true;
+}
+
+/* The object read into holds numbers already, which must all be replaced */
+void TestXmlNumbers::roundTrip() {
+    QFETCH(int, form);
+    QFETCH(bool, empty);
+    QSerializer::Options options;
+    options.xmlNumbers = QSerializer::XmlNumbers(form);
+    QSerializer::SerializationContext ctx;
+    ctx.setClassOptions("Samples", options);
+    Samples written = empty ? Samples() : samples();
+    const QByteArray xml = written.toRawXml(ctx);
+
+    QDomDocument doc;
+    QVERIFY(doc.setContent(xml));
+    QDomElement counts = doc.documentElement().firstChildElement("counts");
+    QCOMPARE(counts.hasAttribute("packed"),
+             form != QSerializer::XmlNumberItems);
+
+    Samples read = samples();
+    read.counts.append(7);
+    read.fromXml(xml);
+    QCOMPARE(read.counts, written.counts);
+    QCOMPARE(read.values.size(), written.values.size());
+    for (int i = 0; i < read.values.size(); i++) {
+        QCOMPARE(read.values[i], written.values[i]);
+        QCOMPARE(std::signbit(read.values[i]),
+                 std::signbit(written.values[i]));
+    }
+    QCOMPARE(read.ids, written.ids);
+}
+
+void TestXmlNumbers::unpack_data() {
+    QTest::addColumn<QString>("packed");
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QVector<int>>("expected");
+
+    QTest::newRow("base64_empty") << "base64" << "" << QVector<int>();
+    QTest::newRow("base64") << "base64" << "AQAAAAIAAAA=" << QVector<int>{1, 2};
+    QTest::newRow("base64_unpadded")
+        << "base64" << "AQAAAAIAAAA" << QVector<int>{1, 2};
+    QTest::newRow("base64_partial_number")
+        << "base64" << "AQAAAAIAAAADAAA=" << QVector<int>{1, 2};
+    QTest::newRow("base64_less_than_one")
+        << "base64" << "AQID" << QVector<int>();
+    QTest::newRow("base64_nine_bytes")
+        << "base64" << "AQAAAAIAAAAD" << QVector<int>{1, 2};
+    QTest::newRow("text_empty") << "text" << "" << QVector<int>();
+    QTest::newRow("text_spaces") << "text" << " \n\t " << QVector<int>();
+    QTest::newRow("text") << "text" << "1 -2 3" << QVector<int>{1, -2, 3};
+    QTest::newRow("text_whitespace")
+        << "text" << "\n  1\t\t-2\r\n3  " << QVector<int>{1, -2, 3};
+    QTest::newRow("text_invalid")
+        << "text" << "1 x 2147483648" << QVector<int>{1, 0, 0};
+}
+
+void TestXmlNumbers::unpack() {
+    QFETCH(QString, packed);
+    QFETCH(QString, text);
+    QFETCH(QVector<int>, expected);
+    QDomDocument doc;
+    QDomElement root = doc.createElement("Samples");
+    QDomElement counts = doc.createElement("counts");
+    counts.setAttribute("packed", packed);
+    counts.appendChild(doc.createTextNode(text));
+    root.appendChild(counts);
+    doc.appendChild(root);
+
+    Samples read;
+    read.counts = {9, 9, 9};
+    read.fromXml(doc);
+    QCOMPARE(read.counts, expected);
+}
+
+/* The binary form is little-endian whatever the byte order of the host */
+void TestXmlNumbers::littleEndian() {
+    QCOMPARE(QSerializer::packLittleEndian(QVector<int>{0x01020304}),
+             QByteArray("\x04\x03\x02\x01", 4));
+    QCOMPARE(QSerializer::packLittleEndian(QVector<double>{1.0}),
+             QByteArray("\x00\x00\x00\x00\x00\x00\xf0\x3f", 8));
+
+    QVector<quint64> ids;
+    QSerializer::unpackLittleEndian(
+        QByteArray("\x08\x07\x06\x05\x04\x03\x02\x01", 8), ids);
+    QCOMPARE(ids, QVector<quint64>{Q_UINT64_C(0x0102030405060708)});
+
+    Samples read;
+    read.fromXml(QByteArray("<Samples><counts packed=\"base64\">BAMCAQ=="
+                            "</counts></Samples>"));
+    QCOMPARE(read.counts, QVector<int>{0x01020304});
+}
+
+QTEST_APPLESS_MAIN(TestXmlNumbers)
+#include "tst_xmlnumbers.moc"
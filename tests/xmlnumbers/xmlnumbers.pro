@@ -0,0 +1,13 @@
+QT -= gui
+QT += testlib
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QS_HAS_JSON QS_HAS_XML
+
+TARGET = tst_xmlnumbers
+
+SOURCES += \
+        tst_xmlnumbers.cpp
+
+include(../../qserializer.pri)
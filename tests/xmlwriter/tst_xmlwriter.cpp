@@ -0,0 +1,42 @@
+#include <QSerializer>
+#include <QTest>
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+#include <QTextCodec>
+#endif
+
+/* Text outside Latin-1 in a field and in a collection */
+class Label : public QSerializer {
+Q_GADGET
+QS_SERIALIZABLE
+QS_FIELD(QString, text)
+QS_COLLECTION(QVector, QString, lines)
+};
+
+/* Compares toRawXml() with QDomDocument::toByteArray() */
+class TestXmlWriter : public QObject {
+Q_OBJECT
+private Q_SLOTS:
+    void rawXml();
+};
+
+/* The first call has no size hint and the later ones do; all of them are
+   UTF-8 whatever the locale */
+void TestXmlWriter::rawXml() {
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    QTextCodec* locale = QTextCodec::codecForLocale();
+    QTextCodec::setCodecForLocale(QTextCodec::codecForName("ISO-8859-1"));
+#endif
+    Label label;
+    label.text = QString::fromUtf8("\xc3\xa9 \xe4\xb8\xad \xf0\x9f\x98\x80");
+    label.lines = {QString::fromUtf8("\xd0\x96"), "<&>"};
+    const QByteArray expected = label.toXml().toDocument().toByteArray();
+    QCOMPARE(label.toRawXml(), expected);
+    QCOMPARE(label.toRawXml(), expected);
+    QVERIFY(expected.contains("\xe4\xb8\xad"));
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    QTextCodec::setCodecForLocale(locale);
+#endif
+}
+
+QTEST_APPLESS_MAIN(TestXmlWriter)
+#include "tst_xmlwriter.moc"